@@ -0,0 +1,37 @@
+#ifndef ACQUISITIONMETRICS_H
+#define ACQUISITIONMETRICS_H
+
+#include <atomic>
+#include <cstdint>
+
+// Live figures for one meter, written by its AcquisitionWorker with relaxed
+// atomic stores and read from any thread (the /metrics endpoint) without
+// locking. Counters only ever go up; gauges are overwritten.
+struct AcquisitionMetrics {
+  // Counters
+  std::atomic<std::uint64_t> samples{0};
+  std::atomic<std::uint64_t> serialErrors{0};
+  std::atomic<std::uint64_t> reconnects{0};
+  std::atomic<std::uint64_t> timeouts{0};
+  std::atomic<std::uint64_t> decodeFailures{0};
+  // MEAS1? round trips and their total time, the latency summary's _count
+  // and _sum; unlike the histogram they survive a statistics reset
+  std::atomic<std::uint64_t> latencyCount{0};
+  std::atomic<std::uint64_t> latencySumNs{0};
+
+  // Gauges
+  std::atomic<bool> connected{false};
+  std::atomic<std::int64_t> lastReadingNs{0}; // Reading::now() clock
+  std::atomic<double> samplesPerSecond{0.0};
+  std::atomic<int> queriesInFlight{0};
+  // MEAS1? round trip, refreshed about once a second
+  std::atomic<std::uint64_t> latencyP50Ns{0};
+  std::atomic<std::uint64_t> latencyP99Ns{0};
+  std::atomic<std::uint64_t> latencyP999Ns{0};
+
+  static void increment(std::atomic<std::uint64_t> &counter) {
+    counter.fetch_add(1, std::memory_order_relaxed);
+  }
+};
+
+#endif // ACQUISITIONMETRICS_H
@@ -0,0 +1,714 @@
+#include "AcquisitionWorker.h"
+
+#include "ScpiDecoder.h"
+
+#include <QDebug>
+#include <QFileInfo>
+#include <QSerialPortInfo>
+#include <algorithm>
+#include <iostream>
+
+static constexpr int kIdentifyTimeoutMs = 2000;
+// How long an adaptive rate estimate is trusted before probing again
+static constexpr qint64 kReprobeMs = 60000;
+
+AcquisitionWorker::AcquisitionWorker(const std::uint8_t device,
+                                     QObject *parent)
+    : QObject(parent), m_device(device) {
+  m_stats_clock.start();
+}
+
+AcquisitionWorker::~AcquisitionWorker() { closePort(); }
+
+void AcquisitionWorker::openPort(const QString &portName) {
+  // Asked for explicitly, so whatever we were reconnecting to is moot
+  stopReconnecting();
+  m_wanted = MeterState();
+  open(portName);
+}
+
+void AcquisitionWorker::open(const QString &portName) {
+  releasePort();
+
+  // Created here rather than in the constructor so port and timer get the
+  // worker thread's affinity.
+  m_port = new QSerialPort(this);
+  m_port->setPortName(portName);
+  m_port->setBaudRate(QSerialPort::Baud115200);
+  m_port->setDataBits(QSerialPort::Data8);
+  m_port->setParity(QSerialPort::NoParity);
+  m_port->setStopBits(QSerialPort::OneStop);
+  m_port->setFlowControl(QSerialPort::NoFlowControl);
+
+  if (!m_port->open(QIODevice::ReadWrite)) {
+    const QString message = "Could not open " + portName + ": " +
+                            m_port->errorString();
+    delete m_port;
+    m_port = nullptr;
+    AcquisitionMetrics::increment(m_metrics->serialErrors);
+    if (m_reconnecting) {
+      retryLater(); // the device node may not be ready yet
+      return;
+    }
+    emit errorOccurred(message);
+    return;
+  }
+  m_port->setReadBufferSize(1024);
+  connect(m_port, &QSerialPort::errorOccurred, this,
+          &AcquisitionWorker::onPortError);
+
+  if (!m_timer) {
+    m_timer = new QTimer(this);
+    m_timer->setSingleShot(false);
+    connect(m_timer, &QTimer::timeout, this, &AcquisitionWorker::poll);
+
+    m_queue = new ScpiCommandQueue(this);
+    connect(m_queue, &ScpiCommandQueue::timedOut, this, [this] {
+      AcquisitionMetrics::increment(m_metrics->timeouts);
+    });
+  }
+  m_queue->attach(m_port);
+
+  m_queue->query(
+      "*IDN?",
+      [this](const bool ok, const QByteArray &line) {
+        if (!m_port) {
+          return; // closed while the probe was in flight
+        }
+        const QString identity = QString::fromLatin1(line).trimmed();
+        if (!ok || identity.split(',').size() < 2) {
+          const QString message =
+              (ok ? "Invalid response from " : "Read timeout from ") +
+              m_port->portName();
+          // We may be inside the port's readyRead handler, so close it later
+          releasePortLater();
+          AcquisitionMetrics::increment(m_metrics->serialErrors);
+          if (m_reconnecting) {
+            retryLater();
+            return;
+          }
+          emit errorOccurred(message);
+          return;
+        }
+        readState([this, portName = m_port->portName(), identity] {
+          if (!m_port) {
+            return;
+          }
+          if (m_ever_connected) {
+            AcquisitionMetrics::increment(m_metrics->reconnects);
+          }
+          m_ever_connected = true;
+          m_metrics->connected.store(true, std::memory_order_relaxed);
+          rememberPort();
+          if (m_reconnecting) {
+            resume();
+            return;
+          }
+          emit connected(portName, identity);
+        });
+      },
+      kIdentifyTimeoutMs);
+}
+
+void AcquisitionWorker::readState(std::function<void()> done) {
+  // All five go out at once; a query the meter ignores times out and fails
+  // the rest, which then simply stay unknown
+  m_shadow = MeterState();
+  m_queue->query("FUNC?", [this](const bool ok, const QByteArray &line) {
+    const MeasurementMode mode =
+        ok ? MeterState::modeFromFunction(QString::fromLatin1(line))
+           : MeasurementMode::Unknown;
+    if (mode != MeasurementMode::Unknown) {
+      m_shadow.mode = mode;
+      m_mode = mode;
+    }
+  });
+  m_queue->query("RANGE?", [this](const bool ok, const QByteArray &line) {
+    const QString range = QString::fromLatin1(line).trimmed().remove('"');
+    if (ok && !range.isEmpty()) {
+      m_shadow.range = range;
+    }
+  });
+  m_queue->query("RATE?", [this](const bool ok, const QByteArray &line) {
+    const QByteArray rate = line.trimmed().toUpper();
+    if (ok && rate == "S") {
+      m_shadow.rate = Settings::Rate::SLOW;
+    } else if (ok && rate == "M") {
+      m_shadow.rate = Settings::Rate::MEDIUM;
+    } else if (ok && rate == "F") {
+      m_shadow.rate = Settings::Rate::FAST;
+    }
+  });
+  m_queue->query("SYST:BEEP:STAT?",
+                 [this](const bool ok, const QByteArray &line) {
+                   const QByteArray beep = line.trimmed().toUpper();
+                   if (ok && (beep == "ON" || beep == "1")) {
+                     m_shadow.beep = true;
+                   } else if (ok && (beep == "OFF" || beep == "0")) {
+                     m_shadow.beep = false;
+                   }
+                 });
+  m_queue->query("CONT:THRE?", [this, done = std::move(done)](
+                                   const bool ok, const QByteArray &line) {
+    bool valid = false;
+    const int threshold = line.trimmed().toInt(&valid);
+    if (ok && valid) {
+      m_shadow.threshold = threshold;
+    }
+    done();
+  });
+}
+
+void AcquisitionWorker::closePort() {
+  stopReconnecting();
+  releasePort();
+}
+
+void AcquisitionWorker::setAutoReconnect(const bool enabled) {
+  m_auto_reconnect = enabled;
+  if (!enabled) {
+    stopReconnecting();
+  }
+}
+
+void AcquisitionWorker::rememberPort() {
+  m_port_name = m_port->portName();
+  const QSerialPortInfo info(*m_port);
+  m_port_serial = info.serialNumber();
+  m_port_has_ids = info.hasVendorIdentifier() && info.hasProductIdentifier();
+  m_port_vendor = info.vendorIdentifier();
+  m_port_product = info.productIdentifier();
+}
+
+bool AcquisitionWorker::lostConnection(const QString &message) {
+  if (!m_auto_reconnect || m_port_name.isEmpty()) {
+    return false;
+  }
+  if (m_timer) {
+    m_timer->stop();
+  }
+  // Usually called from inside a port signal
+  releasePortLater();
+  if (m_reconnecting) {
+    retryLater();
+    return true;
+  }
+  std::cerr << "Lost " << m_port_name.toStdString() << " ("
+            << message.toStdString() << "), reconnecting" << std::endl;
+  m_reconnecting = true;
+  m_gap = true;
+  m_backoff_ms = kReconnectMinMs;
+  m_downtime.start();
+  if (!m_reconnect_timer) {
+    m_reconnect_timer = new QTimer(this);
+    m_reconnect_timer->setSingleShot(true);
+    connect(m_reconnect_timer, &QTimer::timeout, this,
+            &AcquisitionWorker::tryReconnect);
+  }
+  m_reconnect_timer->start(0);
+  emit reconnecting(m_port_name);
+  return true;
+}
+
+void AcquisitionWorker::tryReconnect() {
+  if (!m_reconnecting) {
+    return;
+  }
+  const QString portName = findPort();
+  if (portName.isEmpty()) {
+    // Unplugged; look again soon, without backing off, so it is picked up
+    // right after it reappears
+    m_reconnect_timer->start(kHotplugPollMs);
+    return;
+  }
+  open(portName);
+}
+
+void AcquisitionWorker::retryLater() {
+  m_reconnect_timer->start(m_backoff_ms);
+  m_backoff_ms = std::min(m_backoff_ms * 2, kReconnectMaxMs);
+}
+
+QString AcquisitionWorker::findPort() const {
+  // A device path (or the simulator's symlink) needs no enumeration
+  if (m_port_name.startsWith('/') && QFileInfo::exists(m_port_name)) {
+    return m_port_name;
+  }
+  const auto ports = QSerialPortInfo::availablePorts();
+  for (const auto &info : ports) {
+    if (info.portName() == m_port_name ||
+        info.systemLocation() == m_port_name) {
+      return m_port_name;
+    }
+  }
+  // Replugged USB adapters may come back under another name
+  for (const auto &info : ports) {
+    if (!m_port_serial.isEmpty() && info.serialNumber() == m_port_serial) {
+      return info.systemLocation();
+    }
+  }
+  if (m_port_has_ids && m_port_serial.isEmpty()) {
+    for (const auto &info : ports) {
+      if (info.hasVendorIdentifier() && info.hasProductIdentifier() &&
+          info.vendorIdentifier() == m_port_vendor &&
+          info.productIdentifier() == m_port_product) {
+        return info.systemLocation();
+      }
+    }
+  }
+  return {};
+}
+
+void AcquisitionWorker::resume() {
+  m_reconnecting = false;
+  // The meter may have been power cycled; put back what was asked for
+  apply(m_wanted);
+  if (m_adaptive) {
+    startAdaptivePolling();
+  } else if (m_polling) {
+    startPolling(m_timer->interval());
+  }
+  const qint64 downtime = m_downtime.elapsed();
+  std::cerr << "Reconnected to " << m_port_name.toStdString() << " after "
+            << downtime << " ms" << std::endl;
+  emit reconnected(m_port_name, downtime);
+}
+
+void AcquisitionWorker::stopReconnecting() {
+  m_reconnecting = false;
+  if (m_reconnect_timer) {
+    m_reconnect_timer->stop();
+  }
+}
+
+void AcquisitionWorker::releasePortLater() {
+  // By then a reconnect may have opened a new port; leave that one alone
+  QMetaObject::invokeMethod(
+      this,
+      [this, port = m_port] {
+        if (m_port == port) {
+          releasePort();
+        }
+      },
+      Qt::QueuedConnection);
+}
+
+void AcquisitionWorker::releasePort() {
+  if (m_timer) {
+    m_timer->stop();
+  }
+  // Clear m_port first so response handlers failed by detach() stay quiet
+  QSerialPort *port = m_port;
+  m_port = nullptr;
+  if (m_queue) {
+    m_queue->detach();
+  }
+  m_measurement_in_flight = false;
+  m_secondary_in_flight = false;
+  m_secondary = true;
+  m_shadow = MeterState();
+  m_metrics->connected.store(false, std::memory_order_relaxed);
+  m_metrics->queriesInFlight.store(0, std::memory_order_relaxed);
+  if (port) {
+    if (port->isOpen()) {
+      port->close();
+    }
+    delete port;
+  }
+}
+
+void AcquisitionWorker::sendStatement(const QString &command) {
+  if (!m_port) {
+    std::cerr << "No port open, refusing writeSCPI\n";
+    return;
+  }
+  m_shadow.forget(command);
+  m_queue->statement(command);
+}
+
+void AcquisitionWorker::apply(const MeterState &wanted) {
+  if (!m_port) {
+    std::cerr << "No port open, refusing writeSCPI\n";
+    return;
+  }
+  m_wanted.merge(wanted);
+  if (wanted.mode && *wanted.mode != MeasurementMode::Unknown) {
+    const MeasurementMode mode = *wanted.mode;
+    const bool sameRange =
+        !MeterState::takesRange(mode) || !wanted.range ||
+        (m_shadow.range && MeterState::sameRange(*m_shadow.range,
+                                                 *wanted.range));
+    if (m_shadow.mode != mode || !sameRange) {
+      m_queue->statement(configureCommand(mode, wanted.range.value_or("")));
+      m_shadow.mode = mode;
+      m_shadow.range = wanted.range;
+      m_secondary = true; // the new function may have a secondary display
+      // Some functions (capacitance, frequency) update far slower than
+      // others
+      m_estimator.reset(nominalPeriodNs(m_rate));
+      resetStatistics();
+    }
+    m_mode = mode;
+  }
+  if (wanted.rate) {
+    m_rate = *wanted.rate;
+    if (m_shadow.rate != wanted.rate) {
+      m_queue->statement("RATE " + rateToSerial(m_rate));
+      m_shadow.rate = wanted.rate;
+      m_estimator.reset(nominalPeriodNs(m_rate));
+    }
+  }
+  if (wanted.threshold && m_shadow.threshold != wanted.threshold) {
+    m_queue->statement("CONT:THRE " + QString::number(*wanted.threshold));
+    m_shadow.threshold = wanted.threshold;
+  }
+  if (wanted.beep && m_shadow.beep != wanted.beep) {
+    m_queue->statement(*wanted.beep ? "SYST:BEEP:STAT ON"
+                                    : "SYST:BEEP:STAT OFF");
+    m_shadow.beep = wanted.beep;
+  }
+}
+
+void AcquisitionWorker::configure(const MeasurementMode mode,
+                                  const QString &range) {
+  MeterState wanted;
+  wanted.mode = mode;
+  if (!range.isEmpty()) {
+    wanted.range = range;
+  }
+  apply(wanted);
+}
+
+void AcquisitionWorker::setRate(const Settings::Rate rate) {
+  MeterState wanted;
+  wanted.rate = rate;
+  apply(wanted);
+}
+
+void AcquisitionWorker::startPolling(const int intervalMs) {
+  if (!m_timer) {
+    return;
+  }
+  m_adaptive = false;
+  m_polling = true;
+  m_timer->setSingleShot(false);
+  m_timer->setInterval(intervalMs);
+  m_timer->start();
+}
+
+void AcquisitionWorker::startAdaptivePolling() {
+  if (!m_timer) {
+    return;
+  }
+  m_adaptive = true;
+  m_polling = true;
+  m_timer->setSingleShot(true);
+  m_estimator.reset(nominalPeriodNs(m_rate));
+  m_throughput_clock.start();
+  m_throughput_count = 0;
+  poll();
+}
+
+void AcquisitionWorker::stopPolling() {
+  m_adaptive = false;
+  m_polling = false;
+  if (m_timer) {
+    m_timer->stop();
+  }
+}
+
+void AcquisitionWorker::poll() {
+  if (!m_port) {
+    std::cerr << "Port is NULL, stopping timer" << std::endl;
+    m_timer->stop();
+    return;
+  }
+  if (m_measurement_in_flight || m_secondary_in_flight) {
+    // Previous reading still outstanding; the queue times it out for us
+    return;
+  }
+  m_measurement_in_flight = true;
+  m_pending_ok = false;
+  m_query_sent_ns = Reading::now();
+  m_queue->query("MEAS1?", [this](const bool ok, const QByteArray &line) {
+    onPrimary(ok, line);
+  });
+  if (m_secondary) {
+    // Written in the same event loop pass, so both go out together and
+    // cost one round trip
+    m_secondary_in_flight = true;
+    m_queue->query("MEAS2:SHOW?",
+                   [this](const bool ok, const QByteArray &line) {
+                     onSecondary(ok, line);
+                   });
+  }
+  m_metrics->queriesInFlight.store(m_queue->inFlight(),
+                                   std::memory_order_relaxed);
+}
+
+void AcquisitionWorker::onPrimary(const bool ok, const QByteArray &line) {
+  m_measurement_in_flight = false;
+  if (!m_poll_waiters.empty()) {
+    // line points into the framer's buffer, see proxyResponse()
+    const QByteArray copy(line.constData(), line.size());
+    for (const quint64 id : m_poll_waiters) {
+      emit proxyResponse(id, ok, copy);
+    }
+    m_poll_waiters.clear();
+  }
+  if (ok) {
+    const auto decoded = ScpiDecoder::decode(line.constData(), line.size());
+    if (decoded.ok) {
+      Reading &reading = m_pending;
+      reading = Reading();
+      reading.timestampNs = Reading::now();
+      const bool wasProbing = m_estimator.probing();
+      m_estimator.addSample(m_query_sent_ns, reading.timestampNs,
+                            decoded.value);
+      if (wasProbing && !m_estimator.probing()) {
+        m_estimate_age.start();
+      }
+      reading.mode = m_mode;
+      reading.device = m_device;
+      reading.unit =
+          decoded.unit != Unit::None ? decoded.unit : unitForMode(m_mode);
+      reading.overload = decoded.overload;
+      reading.value = decoded.value;
+      reading.gap = m_gap;
+      m_gap = false;
+      m_pending_ok = true;
+    } else {
+      qDebug() << "Could not decode reading" << line;
+      ++m_queue->statistics().decodeFailures;
+      AcquisitionMetrics::increment(m_metrics->decodeFailures);
+    }
+  }
+  // Responses come back in order, so a secondary still in flight is
+  // answered (or failed) right after this
+  if (!m_secondary_in_flight) {
+    completeMeasurement();
+  }
+}
+
+void AcquisitionWorker::onSecondary(const bool ok, const QByteArray &line) {
+  m_secondary_in_flight = false;
+  const auto decoded = ok ? ScpiDecoder::decode(line.constData(), line.size())
+                          : ScpiDecoder::Result();
+  if (decoded.ok) {
+    m_pending.hasSecondary = true;
+    m_pending.secondary = decoded.value;
+    m_pending.secondaryUnit = decoded.unit;
+    m_pending.secondaryOverload = decoded.overload;
+  } else if (m_pending_ok && m_port) {
+    // The primary came back but this did not: no secondary display
+    qDebug() << "No secondary reading from the meter, polling MEAS1 only";
+    m_secondary = false;
+  }
+  completeMeasurement();
+}
+
+void AcquisitionWorker::completeMeasurement() {
+  m_metrics->queriesInFlight.store(m_queue->inFlight(),
+                                   std::memory_order_relaxed);
+  if (m_pending_ok) {
+    m_pending_ok = false;
+    publish(m_pending);
+  }
+  scheduleNextPoll();
+}
+
+void AcquisitionWorker::scheduleNextPoll() {
+  if (!m_adaptive || !m_port) {
+    return;
+  }
+  if (!m_estimator.probing() && m_estimate_age.elapsed() > kReprobeMs) {
+    m_estimator.reset(nominalPeriodNs(m_rate));
+  }
+  if (m_estimator.probing()) {
+    // Back to back, so no value change goes unseen
+    m_timer->start(0);
+    return;
+  }
+  // One query per meter update; never faster than the link turns around
+  const qint64 period =
+      std::max(m_estimator.updatePeriodNs(), m_estimator.roundTripNs());
+  const qint64 due = m_query_sent_ns + period;
+  const qint64 delayMs = std::max<qint64>(0, (due - Reading::now()) / 1000000);
+  m_timer->start(static_cast<int>(delayMs));
+}
+
+void AcquisitionWorker::attachRing(const std::shared_ptr<ReadingRing> &ring) {
+  m_rings.push_back(ring);
+}
+
+void AcquisitionWorker::detachRing(const std::shared_ptr<ReadingRing> &ring) {
+  m_rings.erase(std::remove(m_rings.begin(), m_rings.end(), ring),
+                m_rings.end());
+}
+
+void AcquisitionWorker::resetStatistics() {
+  m_stats.reset();
+  m_stats_unit = Unit::None;
+  m_stats_clock.start();
+  emit statisticsChanged(m_stats.snapshot(), m_stats_unit);
+}
+
+void AcquisitionWorker::requestIoStatistics() {
+  emit ioStatisticsReady(m_queue ? m_queue->statistics() : IoStatistics());
+}
+
+void AcquisitionWorker::resetIoStatistics() {
+  if (m_queue) {
+    // Count what the histogram has seen so far before it is gone
+    publishLatency();
+    m_queue->statistics().reset();
+    m_latency_count = 0;
+    m_latency_sum_ns = 0;
+  }
+}
+
+void AcquisitionWorker::publishLatency() {
+  const LatencyHistogram &latency = m_queue->statistics().latencyFor("MEAS1?");
+  constexpr auto relaxed = std::memory_order_relaxed;
+  m_metrics->latencyCount.fetch_add(latency.count() - m_latency_count,
+                                    relaxed);
+  m_metrics->latencySumNs.fetch_add(latency.sum() - m_latency_sum_ns,
+                                    relaxed);
+  m_latency_count = latency.count();
+  m_latency_sum_ns = latency.sum();
+  m_metrics->latencyP50Ns.store(latency.percentile(50), relaxed);
+  m_metrics->latencyP99Ns.store(latency.percentile(99), relaxed);
+  m_metrics->latencyP999Ns.store(latency.percentile(99.9), relaxed);
+}
+
+void AcquisitionWorker::proxyQuery(const quint64 id, const QString &command) {
+  if (m_measurement_in_flight &&
+      command.compare("MEAS1?", Qt::CaseInsensitive) == 0 &&
+      Reading::now() - m_query_sent_ns < kCoalesceMs * 1000000LL) {
+    m_poll_waiters.push_back(id);
+    return;
+  }
+  if (!m_queue) {
+    emit proxyResponse(id, false, {});
+    return;
+  }
+  // Goes into the same pipeline as our polls, so framing stays intact
+  m_queue->query(command, [this, id](const bool ok, const QByteArray &line) {
+    emit proxyResponse(id, ok, QByteArray(line.constData(), line.size()));
+  });
+  m_metrics->queriesInFlight.store(m_queue->inFlight(),
+                                   std::memory_order_relaxed);
+}
+
+void AcquisitionWorker::publish(const Reading &reading) {
+  for (const auto &ring : m_rings) {
+    ring->push(reading);
+  }
+  emit readingReady(reading);
+  AcquisitionMetrics::increment(m_metrics->samples);
+  m_metrics->lastReadingNs.store(reading.timestampNs,
+                                 std::memory_order_relaxed);
+
+  if (!reading.overload) {
+    m_stats.add(reading.value);
+    m_stats_unit = reading.unit;
+  }
+  if (m_stats_clock.elapsed() >= 200) {
+    emit statisticsChanged(m_stats.snapshot(), m_stats_unit);
+    m_stats_clock.restart();
+  }
+
+  ++m_throughput_count;
+  if (const qint64 elapsed = m_throughput_clock.elapsed(); elapsed >= 1000) {
+    const qint64 period = m_estimator.updatePeriodNs();
+    const double samplesPerSecond = m_throughput_count * 1000.0 / elapsed;
+    emit throughputChanged(samplesPerSecond, period > 0 ? 1e9 / period : 0.0);
+    m_metrics->samplesPerSecond.store(samplesPerSecond,
+                                      std::memory_order_relaxed);
+    publishLatency();
+    m_throughput_count = 0;
+    m_throughput_clock.restart();
+  }
+}
+
+QString AcquisitionWorker::rateToSerial(const Settings::Rate rate) {
+  switch (rate) {
+  case Settings::Rate::SLOW:
+    return "S";
+  case Settings::Rate::MEDIUM:
+    return "M";
+  case Settings::Rate::FAST:
+    return "F";
+  }
+  return "F";
+}
+
+qint64 AcquisitionWorker::nominalPeriodNs(const Settings::Rate rate) {
+  // Starting guesses only; the estimator measures the real figure
+  switch (rate) {
+  case Settings::Rate::SLOW:
+    return 500000000;
+  case Settings::Rate::MEDIUM:
+    return 200000000;
+  case Settings::Rate::FAST:
+    break;
+  }
+  return 50000000;
+}
+
+void AcquisitionWorker::onPortError(
+    const QSerialPort::SerialPortError error) {
+  if (error == QSerialPort::NoError || error == QSerialPort::TimeoutError) {
+    return;
+  }
+  const QString message = m_port ? m_port->errorString() : QString();
+  AcquisitionMetrics::increment(m_metrics->serialErrors);
+  if (lostConnection(message)) {
+    return;
+  }
+  // Deleting the port from inside its own signal is not safe
+  releasePortLater();
+  if (m_timer) {
+    m_timer->stop();
+  }
+  emit errorOccurred(message);
+}
+
+QString AcquisitionWorker::configureCommand(const MeasurementMode mode,
+                                            const QString &range) {
+  QString function;
+  switch (mode) {
+  case MeasurementMode::VoltageDC:
+    function = "CONF:VOLT:DC";
+    break;
+  case MeasurementMode::VoltageAC:
+    function = "CONF:VOLT:AC";
+    break;
+  case MeasurementMode::CurrentDC:
+    function = "CONF:CURR:DC";
+    break;
+  case MeasurementMode::CurrentAC:
+    function = "CONF:CURR:AC";
+    break;
+  case MeasurementMode::Resistance:
+    function = "CONF:RES";
+    break;
+  case MeasurementMode::Continuity:
+    return "CONF:CONT";
+  case MeasurementMode::Diode:
+    return "CONF:DIOD";
+  case MeasurementMode::Capacitance:
+    function = "CONF:CAP";
+    break;
+  case MeasurementMode::Frequency:
+    return "CONF:FREQ";
+  case MeasurementMode::Period:
+    return "CONF:PER";
+  case MeasurementMode::Temperature:
+    function = "CONF:TEMP:RTD";
+    break;
+  case MeasurementMode::Unknown:
+    return {};
+  }
+  return range.isEmpty() ? function : function + " " + range;
+}
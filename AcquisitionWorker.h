@@ -0,0 +1,237 @@
+#ifndef ACQUISITIONWORKER_H
+#define ACQUISITIONWORKER_H
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QSerialPort>
+#include <QString>
+#include <QTimer>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "AcquisitionMetrics.h"
+#include "MeterState.h"
+#include "RateEstimator.h"
+#include "Reading.h"
+#include "RunningStats.h"
+#include "SampleRing.h"
+#include "ScpiCommandQueue.h"
+#include "Settings.h"
+
+Q_DECLARE_METATYPE(Reading)
+Q_DECLARE_METATYPE(RunningStats::Snapshot)
+
+// Owns the meter's serial port and runs the poll/decode loop. Lives in its
+// own QThread; all interaction from the GUI goes through queued slots and
+// results come back through queued signals.
+class AcquisitionWorker final : public QObject {
+  Q_OBJECT
+
+public:
+  // Samples in the sliding statistics window
+  static constexpr std::size_t kStatisticsWindow = 100;
+  // A proxied MEAS1? this soon after our own poll shares its response
+  static constexpr int kCoalesceMs = 5;
+  // Reconnect attempts back off between these; while the port is missing
+  // altogether it is looked for every kHotplugPollMs instead
+  static constexpr int kReconnectMinMs = 50;
+  static constexpr int kReconnectMaxMs = 2000;
+  static constexpr int kHotplugPollMs = 100;
+
+  explicit AcquisitionWorker(std::uint8_t device = 0,
+                             QObject *parent = nullptr);
+
+  // Stamped into every Reading this worker produces
+  [[nodiscard]] std::uint8_t device() const { return m_device; }
+
+  // Safe to read from any thread
+  [[nodiscard]] std::shared_ptr<const AcquisitionMetrics> metrics() const {
+    return m_metrics;
+  }
+
+  ~AcquisitionWorker() override;
+
+public slots:
+  // Reads the meter's configuration back before emitting connected()
+  void openPort(const QString &portName);
+
+  // Also stops any reconnect in progress
+  void closePort();
+
+  // Once connected, get the port back by ourselves when it goes away: wait
+  // for the USB device to reappear (under its old name or, by serial number,
+  // a new one), reopen with backoff, restore the configuration and resume
+  // polling. Readings keep going to the same rings, the first one after the
+  // outage with gap set. errorOccurred() is not emitted for such outages.
+  void setAutoReconnect(bool enabled);
+
+  void sendStatement(const QString &command);
+
+  // Sends only the commands needed to get from the meter's known state to
+  // the wanted one; fields left empty in wanted are not touched
+  void apply(const MeterState &wanted);
+
+  // Switch the meter's function; readings are tagged with this mode
+  void configure(MeasurementMode mode, const QString &range = {});
+
+  // Sets the rate and restarts rate estimation
+  void setRate(Settings::Rate rate);
+
+  // Poll every intervalMs regardless of what the meter does
+  void startPolling(int intervalMs);
+
+  // Measure how often the meter produces a new value and how long a round
+  // trip takes, then send one query per update
+  void startAdaptivePolling();
+
+  void stopPolling();
+
+  // Every reading is pushed to each attached ring; consumers drain their own
+  // ring at their own pace and never hold up the poll loop.
+  void attachRing(const std::shared_ptr<ReadingRing> &ring);
+
+  void detachRing(const std::shared_ptr<ReadingRing> &ring);
+
+  // Also happens on every configure(), since a new function makes the old
+  // numbers meaningless
+  void resetStatistics();
+
+  // Answered with ioStatisticsReady()
+  void requestIoStatistics();
+
+  void resetIoStatistics();
+
+  // Query on behalf of ScpiProxy, answered with proxyResponse()
+  void proxyQuery(quint64 id, const QString &command);
+
+signals:
+  void connected(const QString &portName, const QString &identity);
+
+  // The port went away; trying to get it back
+  void reconnecting(const QString &portName);
+
+  // Back after reconnecting(), with configuration and polling restored
+  void reconnected(const QString &portName, qint64 downtimeMs);
+
+  void readingReady(const Reading &reading);
+
+  void errorOccurred(const QString &message);
+
+  // Emitted about once a second while readings arrive
+  void throughputChanged(double samplesPerSecond, double meterUpdateHz);
+
+  // Throttled to a few updates per second
+  void statisticsChanged(const RunningStats::Snapshot &statistics, Unit unit);
+
+  void ioStatisticsReady(const IoStatistics &statistics);
+
+  // Crosses to the network thread, so line must own its bytes: never pass
+  // the framer's view (QByteArray::fromRawData) straight through
+  void proxyResponse(quint64 id, bool ok, const QByteArray &line);
+
+private slots:
+  void poll();
+
+  void onPortError(QSerialPort::SerialPortError error);
+
+  void tryReconnect();
+
+private:
+  const std::uint8_t m_device;
+  const std::shared_ptr<AcquisitionMetrics> m_metrics =
+      std::make_shared<AcquisitionMetrics>();
+  bool m_ever_connected = false;
+  bool m_auto_reconnect = false;
+  bool m_reconnecting = false;
+  // Last port we were connected to, and what identifies its USB device
+  QString m_port_name;
+  QString m_port_serial;
+  bool m_port_has_ids = false;
+  quint16 m_port_vendor = 0;
+  quint16 m_port_product = 0;
+  QTimer *m_reconnect_timer = nullptr;
+  int m_backoff_ms = kReconnectMinMs;
+  QElapsedTimer m_downtime;
+  bool m_gap = false;
+  QSerialPort *m_port = nullptr;
+  QTimer *m_timer = nullptr;
+  ScpiCommandQueue *m_queue = nullptr;
+  bool m_measurement_in_flight = false;
+  // MEAS2:SHOW? goes out right behind MEAS1? and completes the reading.
+  // Switched off for the connection if the meter does not answer it.
+  bool m_secondary = true;
+  bool m_secondary_in_flight = false;
+  bool m_pending_ok = false;
+  Reading m_pending;
+  MeasurementMode m_mode = MeasurementMode::Unknown;
+  // What the meter is known to be set to, and everything asked for since
+  // connecting (restored after a reconnect)
+  MeterState m_shadow;
+  MeterState m_wanted;
+  std::vector<std::shared_ptr<ReadingRing>> m_rings;
+
+  Settings::Rate m_rate = Settings::Rate::FAST;
+  bool m_adaptive = false;
+  bool m_polling = false;
+  RateEstimator m_estimator;
+  QElapsedTimer m_estimate_age;
+  qint64 m_query_sent_ns = 0;
+  // Proxied queries waiting for the poll in flight
+  std::vector<quint64> m_poll_waiters;
+  QElapsedTimer m_throughput_clock;
+  int m_throughput_count = 0;
+  // Part of the MEAS1? histogram already added to the metrics counters
+  std::uint64_t m_latency_count = 0;
+  std::uint64_t m_latency_sum_ns = 0;
+  RunningStats m_stats{kStatisticsWindow};
+  QElapsedTimer m_stats_clock;
+  Unit m_stats_unit = Unit::None;
+
+  void open(const QString &portName);
+
+  // Closes the port but leaves reconnecting alone
+  void releasePort();
+
+  // For use inside the port's own signals
+  void releasePortLater();
+
+  void rememberPort();
+
+  // Starts or continues reconnecting; false if we are not supposed to
+  bool lostConnection(const QString &message);
+
+  void retryLater();
+
+  void resume();
+
+  void stopReconnecting();
+
+  // Where the remembered device is now, empty if it is not plugged in
+  QString findPort() const;
+
+  // Queries function, range, rate, beep and threshold into m_shadow
+  void readState(std::function<void()> done);
+
+  void onPrimary(bool ok, const QByteArray &line);
+
+  void onSecondary(bool ok, const QByteArray &line);
+
+  // Both responses are in (or failed); publish and schedule the next poll
+  void completeMeasurement();
+
+  void publish(const Reading &reading);
+
+  // MEAS1? latency quantiles, count and sum into m_metrics
+  void publishLatency();
+
+  void scheduleNextPoll();
+
+  static QString rateToSerial(Settings::Rate rate);
+
+  static qint64 nominalPeriodNs(Settings::Rate rate);
+
+  static QString configureCommand(MeasurementMode mode, const QString &range);
+};
+
+#endif // ACQUISITIONWORKER_H
@@ -17,20 +17,23 @@
 #include <QPushButton>
 #include <QRadioButton> // Ensure this is included (already in .h)
 #include <QSerialPortInfo>
+#include <QShowEvent>
 #include <QVBoxLayout>
 #include <iostream>
 
-ConnectDialog::ConnectDialog(QWidget *parent)
-    : QDialog(parent), serialPort(nullptr) {
+ConnectDialog::ConnectDialog(QWidget *parent) : QDialog(parent) {
   setWindowTitle("Serial Port Connection");
+  m_discovery = new PortDiscovery(this);
+  connect(m_discovery, &PortDiscovery::probed, this,
+          &ConnectDialog::onPortProbed);
+  connect(m_discovery, &PortDiscovery::finished, this,
+          &ConnectDialog::onDiscoveryFinished);
   setupUi();
   populatePortsList();
   loadSettings(); // Load settings when dialog is created
 }
 
-ConnectDialog::~ConnectDialog() {
-  // Port will be owned by the caller or deleted when connection failed
-}
+ConnectDialog::~ConnectDialog() = default;
 
 void ConnectDialog::setupUi() {
   // Main layout
@@ -115,6 +118,8 @@ void ConnectDialog::setupUi() {
   connect(connectButton, &QPushButton::clicked, this,
           &ConnectDialog::connectToPort);
   connect(cancelButton, &QPushButton::clicked, this, &QDialog::reject);
+  connect(portComboBox, QOverload<int>::of(&QComboBox::activated), this,
+          [this](int) { m_user_selected = true; });
   connect(rateButtonGroup, QOverload<int>::of(&QButtonGroup::idClicked), this,
           &ConnectDialog::onRateChanged);
 }
@@ -162,6 +167,14 @@ void ConnectDialog::saveSettings() {
       MainWindow::settings->setRate(
           static_cast<Settings::Rate>(selectedRateId));
     }
+    // The chosen meter keeps its own copy, so other meters on the same
+    // machine can be set up differently
+    if (portComboBox->currentIndex() != -1) {
+      MainWindow::settings->setDeviceSettings(
+          portComboBox->currentData().toString(),
+          {MainWindow::settings->getRate(), m_beep_short->isChecked(),
+           m_beep_diode->isChecked(), m_short_threshold->text().toInt()});
+    }
     MainWindow::settings->save();
   }
 }
@@ -190,136 +203,117 @@ void ConnectDialog::populatePortsList() const {
   connectButton->setEnabled(true);
 }
 
-void ConnectDialog::refreshPorts() const { populatePortsList(); }
-
-bool ConnectDialog::configureSerialPort(const QString &device) {
-  if (serialPort) {
-    delete serialPort;
-  }
-  serialPort = new QSerialPort(this);
-
-  serialPort->setPortName(device);
-  serialPort->setBaudRate(QSerialPort::Baud115200); // Typical for SCPI devices
-  serialPort->setDataBits(QSerialPort::Data8);
-  serialPort->setParity(QSerialPort::NoParity);
-  serialPort->setStopBits(QSerialPort::OneStop);
-  serialPort->setFlowControl(QSerialPort::NoFlowControl);
-
-  // Add more verbose error handling
-  if (!serialPort->open(QIODevice::ReadWrite)) {
-    qDebug() << "Failed to open serial port:" << serialPort->errorString();
-    return false;
-  }
-
-  // Configure timeouts
-  serialPort->setReadBufferSize(1024); // Increase read buffer size
+void ConnectDialog::refreshPorts() {
+  populatePortsList();
+  discoverPorts();
+}
 
-  return true;
+void ConnectDialog::showEvent(QShowEvent *event) {
+  QDialog::showEvent(event);
+  // Only probe while the dialog is up; otherwise we would be holding ports
+  // the acquisition worker wants to open
+  refreshPorts();
 }
 
-bool ConnectDialog::tryPortByName(const QString &portName) {
-  configureSerialPort(portName);
-  saveSettings(); // Save settings before trying the port
-  tryConfiguredPort();
-  return m_check_ok;
+void ConnectDialog::done(const int result) {
+  m_discovery->cancel();
+  QDialog::done(result);
 }
 
-void ConnectDialog::tryPort() {
-  if (portComboBox->currentIndex() == -1) {
-    statusLabel->setText("No serial port selected.");
-    statusLabel->setStyleSheet("QLabel { color: red; }");
-    m_check_ok = false;
+void ConnectDialog::discoverPorts(const QString &portName) {
+  m_results.erase(portName);
+  if (portName.isEmpty()) {
+    m_results.clear();
+    m_auto_selected = false;
+  }
+  QList<QSerialPortInfo> ports;
+  if (!portName.isEmpty()) {
+    ports.append(QSerialPortInfo(portName));
+  } else if (portComboBox->count() == 0) {
     return;
   }
-  configureSerialPort(portComboBox->currentData().toString());
-  saveSettings(); // Save settings before trying the port
-  tryConfiguredPort();
+  statusLabel->setText("Looking for meters...");
+  statusLabel->setStyleSheet("QLabel { color: blue; }"); // Indicate activity
+  m_discovery->start(ports);
 }
 
-void ConnectDialog::tryConfiguredPort() {
-  if (!serialPort) {
-    // Should not happen if configureSerialPort was called
-    statusLabel->setText("Serial port not initialized.");
-    statusLabel->setStyleSheet("QLabel { color: red; }");
-    m_check_ok = false;
+void ConnectDialog::onPortProbed(const PortDiscovery::Result &result) {
+  m_results[result.portName] = result;
+  const int index = portComboBox->findData(result.portName);
+  if (index == -1) {
     return;
   }
-  if (serialPort->isOpen()) {
-    serialPort->close();
+  if (result.ok) {
+    portComboBox->setItemText(index, result.portName + " - " + result.model +
+                                         " (FW: " + result.firmware + ")");
   }
-  if (!serialPort->open(QIODevice::ReadWrite)) {
-    statusLabel->setText("Could not open: " + serialPort->errorString());
-    statusLabel->setStyleSheet("QLabel { color: red; }");
-    // No need to delete serialPort here, configureSerialPort handles it or it's
-    // parented
-    m_check_ok = false;
-    return;
+  // Pick the first meter found, unless the user already chose something
+  if (result.isOwon() && !m_auto_selected && !m_user_selected) {
+    m_auto_selected = true;
+    portComboBox->setCurrentIndex(index);
   }
+  if (result.portName == getSelectedPort()) {
+    showResult(result);
+  }
+}
 
-  statusLabel->setText("Testing communication...");
-  statusLabel->setStyleSheet("QLabel { color: blue; }"); // Indicate activity
-
-  serialPort->write("*IDN?\n");
-  if (!serialPort->waitForBytesWritten(1000)) {
-    statusLabel->setText("Write timeout to " + serialPort->portName());
-    statusLabel->setStyleSheet("QLabel { color: red; }");
-    serialPort->close();
-    m_check_ok = false;
+void ConnectDialog::onDiscoveryFinished() {
+  if (m_connect_pending) {
+    m_connect_pending = false;
+    connectToPort();
     return;
   }
-  if (!serialPort->waitForReadyRead(2000)) {
-    // Increased timeout slightly
-    statusLabel->setText("Read timeout from " + serialPort->portName());
+  const auto it = m_results.find(getSelectedPort());
+  if (it != m_results.end()) {
+    showResult(it->second);
+  } else {
+    statusLabel->setText("No meter found.");
     statusLabel->setStyleSheet("QLabel { color: red; }");
-    serialPort->close();
-    m_check_ok = false;
-    return;
   }
-  char buffer[1024] = {0}; // Initialize buffer
-  qint64 bytesRead = serialPort->readLine(buffer, sizeof(buffer) - 1);
+}
 
-  if (bytesRead <= 0) {
-    statusLabel->setText("No response from " + serialPort->portName());
+void ConnectDialog::showResult(const PortDiscovery::Result &result) const {
+  if (result.ok) {
+    statusLabel->setText("Connected: " + result.model +
+                         " (FW: " + result.firmware + ")");
+    statusLabel->setStyleSheet("QLabel { color: green; }");
+  } else {
+    statusLabel->setText(result.portName + ": " + result.error);
     statusLabel->setStyleSheet("QLabel { color: red; }");
-    serialPort->close();
-    m_check_ok = false;
-    return;
   }
+}
 
-  const QString input(buffer);
-  QStringList parts = input.trimmed().split(','); // Trim whitespace
-
-  if (parts.size() < 2) {
-    // Check for at least model (often 4 parts: Manufacturer,Model,SN,Firmware)
-    statusLabel->setText("Invalid response: " +
-                         input.left(50)); // Show part of response
+void ConnectDialog::tryPort() {
+  if (portComboBox->currentIndex() == -1) {
+    statusLabel->setText("No serial port selected.");
     statusLabel->setStyleSheet("QLabel { color: red; }");
-    serialPort->close();
-    m_check_ok = false;
     return;
   }
-  const QString model = parts.value(1, "Unknown Model").trimmed();
-  const QString version = parts.value(3, "Unknown Fw").trimmed();
-
-  statusLabel->setText("Connected: " + model + " (FW: " + version + ")");
-  statusLabel->setStyleSheet("QLabel { color: green; }");
-  m_check_ok = true;
-  // Do not close the port here if the test is successful and it's intended to
-  // be used by "Connect"
+  saveSettings(); // Save settings before trying the port
+  discoverPorts(getSelectedPort());
 }
 
 void ConnectDialog::connectToPort() {
-  tryPort();
-  if (m_check_ok) {
+  const QString portName = getSelectedPort();
+  if (portName.isEmpty()) {
+    statusLabel->setText("No serial port selected.");
+    statusLabel->setStyleSheet("QLabel { color: red; }");
+    return;
+  }
+  const auto it = m_results.find(portName);
+  if (it == m_results.end()) {
+    // Not probed yet (or still in progress); connect once we know
+    m_connect_pending = true;
+    if (!m_discovery->running()) {
+      tryPort();
+    }
+    return;
+  }
+  if (it->second.ok) {
+    saveSettings();
     accept();
   } else {
-    if (serialPort) {
-      if (serialPort->isOpen()) {
-        serialPort->close();
-      }
-      delete serialPort;
-      serialPort = nullptr;
-    }
+    showResult(it->second);
   }
 }
 
@@ -329,11 +323,3 @@ QString ConnectDialog::getSelectedPort() const {
   }
   return portComboBox->currentData().toString();
 }
-
-QSerialPort *ConnectDialog::getConfiguredSerialPort() const {
-  // The serialPort member is configured in tryPort/tryPortByName
-  // It's up to the caller (MainWindow) to manage this port after the dialog is
-  // accepted. If m_check_ok is true, serialPort should be valid and potentially
-  // open.
-  return m_check_ok ? serialPort : nullptr;
-}
\ No newline at end of file
@@ -8,8 +8,10 @@
 #include <QLabel>
 #include <QPushButton>
 #include <QRadioButton>
-#include <QSerialPort>
 #include <QString>
+#include <map>
+
+#include "PortDiscovery.h"
 
 class ConnectDialog final : public QDialog {
   Q_OBJECT
@@ -19,16 +21,16 @@ public:
 
   ~ConnectDialog() override;
 
-  // Get the selected serial port
+  // Get the selected serial port; only answers *IDN? once accepted
   QString getSelectedPort() const;
 
-  // Get configured serial port (with settings applied)
-  QSerialPort *getConfiguredSerialPort() const;
+  void done(int result) override;
 
-  bool tryPortByName(const QString &portName);
+protected:
+  void showEvent(QShowEvent *event) override;
 
 private slots:
-  void refreshPorts() const;
+  void refreshPorts();
 
   void connectToPort();
 
@@ -36,6 +38,10 @@ private slots:
 
   void onRateChanged(int id); // Slot to handle rate changes
 
+  void onPortProbed(const PortDiscovery::Result &result);
+
+  void onDiscoveryFinished();
+
 private:
   // UI Elements
   QComboBox *portComboBox;
@@ -57,25 +63,26 @@ private:
   QRadioButton *fastRateButton;   // Added
   QButtonGroup *rateButtonGroup;  // Added
 
-  // Active serial port (set when connecting successfully)
-  QSerialPort *serialPort = nullptr;
-  // const QString *status; // This was unused
-  // bool isError = false; // This was unused
+  PortDiscovery *m_discovery = nullptr;
+  // Latest probe result per port name
+  std::map<QString, PortDiscovery::Result> m_results;
+  bool m_auto_selected = false;
+  bool m_user_selected = false;
+  // Connect was clicked before the selected port had been probed
+  bool m_connect_pending = false;
 
   // Methods
   void setupUi();
 
   void populatePortsList() const;
 
-  bool configureSerialPort(const QString &device);
+  // All ports when portName is empty
+  void discoverPorts(const QString &portName = {});
 
-  void tryConfiguredPort();
+  void showResult(const PortDiscovery::Result &result) const;
 
   void loadSettings(); // Added
   void saveSettings(); // Added
-
-private:
-  bool m_check_ok = false;
 };
 
 #endif // CONNECTDIALOG_H
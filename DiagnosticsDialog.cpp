@@ -0,0 +1,98 @@
+#include "DiagnosticsDialog.h"
+
+#include <QDialogButtonBox>
+#include <QFile>
+#include <QFileDialog>
+#include <QFontDatabase>
+#include <QJsonDocument>
+#include <QMessageBox>
+#include <QPushButton>
+#include <QVBoxLayout>
+
+DiagnosticsDialog::DiagnosticsDialog(AcquisitionWorker *worker,
+                                     QWidget *parent)
+    : QDialog(parent), m_worker(worker) {
+  setWindowTitle("SCPI Diagnostics");
+  resize(640, 360);
+
+  auto mainLayout = new QVBoxLayout(this);
+  m_text = new QPlainTextEdit(this);
+  m_text->setReadOnly(true);
+  m_text->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+  m_text->setLineWrapMode(QPlainTextEdit::NoWrap);
+  mainLayout->addWidget(m_text);
+
+  auto buttonBox = new QDialogButtonBox(this);
+  const auto resetButton = new QPushButton("Reset");
+  const auto exportButton = new QPushButton("Export...");
+  buttonBox->addButton(resetButton, QDialogButtonBox::ResetRole);
+  buttonBox->addButton(exportButton, QDialogButtonBox::ActionRole);
+  buttonBox->addButton(QDialogButtonBox::Close);
+  mainLayout->addWidget(buttonBox);
+
+  connect(resetButton, &QPushButton::clicked, this,
+          &DiagnosticsDialog::onReset);
+  connect(exportButton, &QPushButton::clicked, this,
+          &DiagnosticsDialog::onExport);
+  connect(buttonBox, &QDialogButtonBox::rejected, this, &QDialog::reject);
+  connect(m_worker, &AcquisitionWorker::ioStatisticsReady, this,
+          &DiagnosticsDialog::onStatistics);
+
+  m_timer = new QTimer(this);
+  m_timer->setInterval(1000);
+  connect(m_timer, &QTimer::timeout, this, &DiagnosticsDialog::refresh);
+}
+
+void DiagnosticsDialog::showEvent(QShowEvent *event) {
+  QDialog::showEvent(event);
+  refresh();
+  m_timer->start();
+}
+
+void DiagnosticsDialog::hideEvent(QHideEvent *event) {
+  // Nothing to collect while nobody is looking
+  m_timer->stop();
+  QDialog::hideEvent(event);
+}
+
+void DiagnosticsDialog::refresh() {
+  QMetaObject::invokeMethod(
+      m_worker, [worker = m_worker] { worker->requestIoStatistics(); },
+      Qt::QueuedConnection);
+}
+
+void DiagnosticsDialog::onStatistics(const IoStatistics &statistics) {
+  m_statistics = statistics;
+  m_text->setPlainText(statistics.toText());
+}
+
+void DiagnosticsDialog::onReset() {
+  QMetaObject::invokeMethod(
+      m_worker,
+      [worker = m_worker] {
+        worker->resetIoStatistics();
+        worker->requestIoStatistics();
+      },
+      Qt::QueuedConnection);
+}
+
+void DiagnosticsDialog::onExport() {
+  const QString path = QFileDialog::getSaveFileName(
+      this, "Export diagnostics", "owon-diagnostics.json",
+      "JSON (*.json);;Text (*.txt)");
+  if (path.isEmpty()) {
+    return;
+  }
+  QFile file(path);
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+    QMessageBox::warning(this, "Export failed",
+                         "Could not write " + path + ": " +
+                             file.errorString());
+    return;
+  }
+  if (path.endsWith(".json", Qt::CaseInsensitive)) {
+    file.write(QJsonDocument(m_statistics.toJson()).toJson());
+  } else {
+    file.write(m_statistics.toText().toUtf8());
+  }
+}
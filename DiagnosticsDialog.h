@@ -0,0 +1,41 @@
+#ifndef DIAGNOSTICSDIALOG_H
+#define DIAGNOSTICSDIALOG_H
+
+#include <QDialog>
+#include <QPlainTextEdit>
+#include <QTimer>
+
+#include "AcquisitionWorker.h"
+#include "IoStatistics.h"
+
+// Live view of the SCPI link: round-trip latency per command and I/O
+// counters, refreshed once a second while open, with export to a file.
+class DiagnosticsDialog final : public QDialog {
+  Q_OBJECT
+
+public:
+  explicit DiagnosticsDialog(AcquisitionWorker *worker,
+                             QWidget *parent = nullptr);
+
+protected:
+  void showEvent(QShowEvent *event) override;
+
+  void hideEvent(QHideEvent *event) override;
+
+private slots:
+  void refresh();
+
+  void onStatistics(const IoStatistics &statistics);
+
+  void onReset();
+
+  void onExport();
+
+private:
+  AcquisitionWorker *m_worker;
+  QPlainTextEdit *m_text;
+  QTimer *m_timer;
+  IoStatistics m_statistics;
+};
+
+#endif // DIAGNOSTICSDIALOG_H
@@ -0,0 +1,433 @@
+#include "HeadlessRunner.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <algorithm>
+#include <atomic>
+#include <csignal>
+#include <cstring>
+#include <iostream>
+#include <map>
+
+#include "ReadingFormat.h"
+
+static std::atomic<bool> s_interrupted{false};
+
+static void onSignal(int) { s_interrupted = true; }
+
+bool HeadlessRunner::modeFromName(const QString &name, MeasurementMode &mode) {
+  static const std::map<QString, MeasurementMode> modes = {
+      {"vdc", MeasurementMode::VoltageDC},
+      {"vac", MeasurementMode::VoltageAC},
+      {"idc", MeasurementMode::CurrentDC},
+      {"iac", MeasurementMode::CurrentAC},
+      {"res", MeasurementMode::Resistance},
+      {"cont", MeasurementMode::Continuity},
+      {"diode", MeasurementMode::Diode},
+      {"cap", MeasurementMode::Capacitance},
+      {"freq", MeasurementMode::Frequency},
+      {"per", MeasurementMode::Period},
+      {"temp", MeasurementMode::Temperature},
+  };
+  const auto it = modes.find(name.toLower());
+  if (it == modes.end()) {
+    return false;
+  }
+  mode = it->second;
+  return true;
+}
+
+bool HeadlessRunner::parseArguments(const QStringList &arguments,
+                                    Options &options, QString &error) {
+  QCommandLineParser parser;
+  parser.setApplicationDescription("OWON XDM-1041 acquisition");
+  parser.addHelpOption();
+  parser.addOptions({
+      {"headless", "Run without a window."},
+      {"port", "Serial device, e.g. /dev/ttyUSB0 or COM3. Repeat for more "
+               "meters.",
+       "device"},
+      {"rate", "Meter rate: slow, medium or fast.", "rate", "fast"},
+      {"mode",
+       "Function: vdc, vac, idc, iac, res, cont, diode, cap, freq, per, temp.",
+       "mode", "vdc"},
+      {"range", "Range argument for the CONF command.", "range", "AUTO"},
+      {"out", "Recording file, or - for CSV on stdout.", "file", "-"},
+      {"duration", "Stop after this many seconds.", "seconds", "0"},
+      {"trigger",
+       "Record only around events: below:V, above:V, falling:V, rising:V, "
+       "crossing:V (each with optional ,hysteresis), outside:LOW,HIGH or "
+       "slope[+-]:PER_SECOND.",
+       "condition"},
+      {"pre", "Samples kept from before each trigger.", "samples", "1000"},
+      {"post", "Samples recorded after each trigger.", "samples", "1000"},
+      {"listen", "Address for the network services.", "address",
+       "127.0.0.1"},
+      {"stream-port", "Stream readings to TCP clients on this port.", "port",
+       "0"},
+      {"metrics-port", "Serve Prometheus metrics on this port.", "port", "0"},
+      {"proxy-port", "Share the first meter with SCPI clients on this port.",
+       "port", "0"},
+  });
+  if (!parser.parse(arguments)) {
+    error = parser.errorText();
+    return false;
+  }
+  if (parser.isSet("help")) {
+    error = parser.helpText();
+    return false;
+  }
+
+  options.ports = parser.values("port");
+  if (options.ports.isEmpty()) {
+    error = "--port is required in headless mode";
+    return false;
+  }
+  if (options.ports.size() > static_cast<int>(InstrumentPool::kMaxInstruments)) {
+    error = "Too many meters";
+    return false;
+  }
+  const QString rate = parser.value("rate").toLower();
+  if (rate != "slow" && rate != "medium" && rate != "fast") {
+    error = "Unknown rate " + rate;
+    return false;
+  }
+  options.rate = Settings::stringToRate(rate, Settings::Rate::FAST);
+  if (!modeFromName(parser.value("mode"), options.mode)) {
+    error = "Unknown mode " + parser.value("mode");
+    return false;
+  }
+  options.range = parser.value("range");
+  options.out = parser.value("out");
+  bool ok = false;
+  options.duration = parser.value("duration").toDouble(&ok);
+  if (!ok || options.duration < 0) {
+    error = "Invalid duration " + parser.value("duration");
+    return false;
+  }
+  if (parser.isSet("trigger")) {
+    std::string message;
+    if (!TriggerEngine::parse(parser.value("trigger").toStdString(),
+                              options.condition, message)) {
+      error = QString::fromStdString(message);
+      return false;
+    }
+    if (options.out.isEmpty() || options.out == "-") {
+      error = "--trigger needs a recording file (--out)";
+      return false;
+    }
+    options.trigger = true;
+  }
+  const qulonglong preSamples = parser.value("pre").toULongLong(&ok);
+  if (!ok || preSamples > 10000000) {
+    error = "Invalid pre-trigger sample count " + parser.value("pre");
+    return false;
+  }
+  options.preSamples = preSamples;
+  const qulonglong postSamples = parser.value("post").toULongLong(&ok);
+  if (!ok || postSamples > 10000000) {
+    error = "Invalid post-trigger sample count " + parser.value("post");
+    return false;
+  }
+  options.postSamples = postSamples;
+  options.listen = parser.value("listen");
+  if (QHostAddress(options.listen).isNull()) {
+    error = "Invalid listen address " + options.listen;
+    return false;
+  }
+  const auto parsePort = [&parser, &error](const QString &name,
+                                           quint16 &port) {
+    bool valid = false;
+    const uint value = parser.value(name).toUInt(&valid);
+    if (!valid || value > 65535) {
+      error = "Invalid " + name + " " + parser.value(name);
+      return false;
+    }
+    port = static_cast<quint16>(value);
+    return true;
+  };
+  return parsePort("stream-port", options.streamPort) &&
+         parsePort("metrics-port", options.metricsPort) &&
+         parsePort("proxy-port", options.proxyPort);
+}
+
+HeadlessRunner::HeadlessRunner(Options options, QObject *parent)
+    : QObject(parent), m_options(std::move(options)),
+      m_ring(std::make_shared<ReadingRing>(8192)), m_batch(1024) {}
+
+HeadlessRunner::~HeadlessRunner() {
+  if (m_instruments) {
+    m_instruments->shutdown();
+  }
+  if (m_recording_thread) {
+    m_recording_thread->quit();
+    m_recording_thread->wait();
+  }
+  if (m_network_thread) {
+    m_network_thread->quit();
+    m_network_thread->wait();
+  }
+}
+
+void HeadlessRunner::start() {
+  std::signal(SIGINT, onSignal);
+  std::signal(SIGTERM, onSignal);
+
+  if (!toStdout()) {
+    // Disk writes for all meters share one thread, like acquisition does
+    m_recording_thread = new QThread(this);
+    m_recording_thread->start();
+  }
+
+  m_instruments = new InstrumentPool(this);
+  for (const QString &port : m_options.ports) {
+    AcquisitionWorker *worker = m_instruments->add();
+    const std::size_t device = worker->device();
+    connect(worker, &AcquisitionWorker::connected, this,
+            [this, device](const QString &portName, const QString &identity) {
+              onConnected(device, portName, identity);
+            });
+    connect(worker, &AcquisitionWorker::errorOccurred, this,
+            [this, device](const QString &message) {
+              onError(device, message);
+            });
+
+    if (m_recording_thread) {
+      auto *recorder = new Recorder;
+      if (m_options.trigger) {
+        recorder->setTrigger(m_options.condition, m_options.preSamples,
+                             m_options.postSamples);
+        connect(recorder, &Recorder::triggered, this,
+                [this, device](const qint64 timestampNs) {
+                  std::cerr << "Meter " << device + 1 << ": triggered at "
+                            << (timestampNs - m_instruments->epochNs()) / 1e9
+                            << " s" << std::endl;
+                });
+      }
+      recorder->moveToThread(m_recording_thread);
+      connect(m_recording_thread, &QThread::finished, recorder,
+              &QObject::deleteLater);
+      connect(recorder, &Recorder::errorOccurred, this,
+              [this, device](const QString &message) {
+                // Losing data silently is worse than stopping
+                std::cerr << "Meter " << device + 1 << ": "
+                          << message.toStdString() << std::endl;
+                finish(1);
+              });
+      m_recorders.push_back(recorder);
+    }
+
+    // Unattended, so ride out cable bumps and meter power cycles
+    QMetaObject::invokeMethod(
+        worker,
+        [worker, port] {
+          worker->setAutoReconnect(true);
+          worker->openPort(port);
+        },
+        Qt::QueuedConnection);
+  }
+  m_alive = m_instruments->size();
+  m_failed.assign(m_alive, false);
+  startNetworkServices();
+
+  if (toStdout()) {
+    std::fputs("device,time_s,value,unit,overload\n", stdout);
+    m_instruments->attachRing(m_ring);
+  }
+
+  m_drain_timer = new QTimer(this);
+  m_drain_timer->setInterval(100);
+  connect(m_drain_timer, &QTimer::timeout, this, &HeadlessRunner::drain);
+  m_drain_timer->start();
+
+  if (m_options.duration > 0) {
+    QTimer::singleShot(static_cast<int>(m_options.duration * 1000), this,
+                       [this] { finish(0); });
+  }
+}
+
+QString HeadlessRunner::outputPath(const std::size_t device) const {
+  if (m_options.ports.size() == 1) {
+    return m_options.out;
+  }
+  // capture.owr -> capture-1.owr, capture-2.owr, ...
+  const QString number = "-" + QString::number(device + 1);
+  const int dot = m_options.out.lastIndexOf('.');
+  const int slash = std::max(m_options.out.lastIndexOf('/'),
+                             m_options.out.lastIndexOf('\\'));
+  if (dot <= slash + 1) {
+    return m_options.out + number;
+  }
+  QString path = m_options.out;
+  return path.insert(dot, number);
+}
+
+void HeadlessRunner::startNetworkServices() {
+  if (m_options.streamPort == 0 && m_options.metricsPort == 0 &&
+      m_options.proxyPort == 0) {
+    return;
+  }
+  m_network_thread = new QThread(this);
+  m_network_thread->setObjectName("network");
+  const QHostAddress address(m_options.listen);
+  const auto onServiceError = [this](const QString &message) {
+    std::cerr << message.toStdString() << std::endl;
+    finish(1);
+  };
+
+  if (m_options.streamPort != 0) {
+    m_stream_server = new StreamServer;
+    m_stream_server->moveToThread(m_network_thread);
+    connect(m_network_thread, &QThread::finished, m_stream_server,
+            &QObject::deleteLater);
+    connect(m_stream_server, &StreamServer::errorOccurred, this,
+            onServiceError);
+    m_instruments->attachRing(m_stream_server->ring());
+    QMetaObject::invokeMethod(
+        m_stream_server,
+        [server = m_stream_server, address, port = m_options.streamPort,
+         epoch = m_instruments->epochNs()] {
+          server->listen(address, port, epoch);
+        },
+        Qt::QueuedConnection);
+  }
+
+  if (m_options.metricsPort != 0) {
+    auto *metrics = new MetricsServer;
+    for (std::size_t i = 0; i < m_instruments->size(); ++i) {
+      metrics->addDevice(m_instruments->worker(i)->metrics());
+    }
+    if (toStdout()) {
+      metrics->addRing("stdout", m_ring);
+    }
+    for (std::size_t i = 0; i < m_recorders.size(); ++i) {
+      metrics->addRing("recorder" + QString::number(i + 1),
+                       m_recorders[i]->ring());
+    }
+    if (m_stream_server) {
+      metrics->addRing("stream", m_stream_server->ring());
+    }
+    metrics->moveToThread(m_network_thread);
+    connect(m_network_thread, &QThread::finished, metrics,
+            &QObject::deleteLater);
+    connect(metrics, &MetricsServer::errorOccurred, this, onServiceError);
+    QMetaObject::invokeMethod(
+        metrics,
+        [metrics, address, port = m_options.metricsPort] {
+          metrics->listen(address, port);
+        },
+        Qt::QueuedConnection);
+  }
+
+  if (m_options.proxyPort != 0) {
+    auto *proxy = new ScpiProxy(m_instruments->worker(0));
+    proxy->moveToThread(m_network_thread);
+    connect(m_network_thread, &QThread::finished, proxy,
+            &QObject::deleteLater);
+    connect(proxy, &ScpiProxy::errorOccurred, this, onServiceError);
+    QMetaObject::invokeMethod(
+        proxy,
+        [proxy, address, port = m_options.proxyPort] {
+          proxy->listen(address, port);
+        },
+        Qt::QueuedConnection);
+  }
+
+  m_network_thread->start();
+}
+
+void HeadlessRunner::onConnected(const std::size_t device,
+                                 const QString &portName,
+                                 const QString &identity) {
+  std::cerr << "Connected to " << identity.toStdString() << " on "
+            << portName.toStdString() << std::endl;
+  AcquisitionWorker *worker = m_instruments->worker(device);
+
+  if (device < m_recorders.size()) {
+    Recorder *recorder = m_recorders[device];
+    RecordingHeader header = RecordingHeader::make();
+    header.mode = static_cast<std::uint8_t>(m_options.mode);
+    header.rate = static_cast<std::uint8_t>(m_options.rate);
+    header.startTimestampNs = Reading::now();
+    header.startEpochMs = QDateTime::currentMSecsSinceEpoch();
+    const QByteArray id = identity.toLatin1();
+    std::memcpy(header.identity, id.constData(),
+                std::min<std::size_t>(id.size(), sizeof(header.identity) - 1));
+    const QByteArray range = m_options.range.toLatin1();
+    std::memcpy(header.range, range.constData(),
+                std::min<std::size_t>(range.size(), sizeof(header.range) - 1));
+    QMetaObject::invokeMethod(
+        recorder,
+        [recorder, path = outputPath(device), header] {
+          recorder->start(path, header);
+        },
+        Qt::QueuedConnection);
+    QMetaObject::invokeMethod(
+        worker, [worker, ring = recorder->ring()] { worker->attachRing(ring); },
+        Qt::QueuedConnection);
+  }
+
+  QMetaObject::invokeMethod(
+      worker,
+      [worker, options = m_options] {
+        MeterState wanted;
+        wanted.mode = options.mode;
+        wanted.range = options.range;
+        wanted.rate = options.rate;
+        wanted.beep = false;
+        worker->apply(wanted);
+        worker->startAdaptivePolling();
+      },
+      Qt::QueuedConnection);
+}
+
+void HeadlessRunner::onError(const std::size_t device,
+                             const QString &message) {
+  std::cerr << "Meter " << device + 1 << ": " << message.toStdString()
+            << std::endl;
+  // The worker closes its port on errors; keep the others running
+  if (device >= m_failed.size() || m_failed[device]) {
+    return;
+  }
+  m_failed[device] = true;
+  if (m_alive > 0 && --m_alive == 0) {
+    finish(1);
+  }
+}
+
+void HeadlessRunner::drain() {
+  if (s_interrupted && m_drain_timer->isActive()) {
+    finish(0);
+    return;
+  }
+  if (!toStdout()) {
+    return; // the recorders drain their own rings
+  }
+  std::size_t count;
+  while ((count = m_ring->popBulk(m_batch.data(), m_batch.size())) > 0) {
+    for (std::size_t i = 0; i < count; ++i) {
+      const Reading &reading = m_batch[i];
+      std::fprintf(stdout, "%d,%.6f,%.9g,%s,%d\n", reading.device + 1,
+                   (reading.timestampNs - m_instruments->epochNs()) / 1e9,
+                   reading.value,
+                   unitSymbol(reading.unit).toUtf8().constData(),
+                   reading.overload ? 1 : 0);
+    }
+  }
+  std::fflush(stdout);
+  if (const auto overruns = m_ring->overruns(); overruns != m_overruns) {
+    std::cerr << "stdout fell behind, " << overruns - m_overruns
+              << " readings dropped" << std::endl;
+    m_overruns = overruns;
+  }
+}
+
+void HeadlessRunner::finish(const int exitCode) {
+  m_drain_timer->stop();
+  if (toStdout()) {
+    drain();
+  }
+  // Stopping the threads (destructor) closes the port and the recording
+  QCoreApplication::exit(exitCode);
+}
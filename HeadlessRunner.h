@@ -0,0 +1,100 @@
+#ifndef HEADLESSRUNNER_H
+#define HEADLESSRUNNER_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QThread>
+#include <QTimer>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+#include "AcquisitionWorker.h"
+#include "InstrumentPool.h"
+#include "MetricsServer.h"
+#include "Recorder.h"
+#include "ScpiProxy.h"
+#include "StreamServer.h"
+#include "Settings.h"
+
+// Display-less acquisition for rack machines: connects, configures the meters
+// from the command line and streams readings to stdout (CSV) or to recording
+// files. Uses only QtCore and the same workers as the GUI.
+class HeadlessRunner final : public QObject {
+  Q_OBJECT
+
+public:
+  struct Options {
+    // --port may be given once per meter
+    QStringList ports;
+    Settings::Rate rate = Settings::Rate::FAST;
+    MeasurementMode mode = MeasurementMode::VoltageDC;
+    QString range = "AUTO";
+    // Empty or "-" streams CSV to stdout, anything else is a recording file
+    // (one per meter, numbered when there are several)
+    QString out;
+    // Stop after this many seconds, 0 runs until interrupted
+    double duration = 0;
+    // Record only the samples around trigger events (needs --out)
+    bool trigger = false;
+    TriggerEngine::Condition condition;
+    std::size_t preSamples = 1000;
+    std::size_t postSamples = 1000;
+    // Local services, off when 0
+    QString listen = "127.0.0.1";
+    quint16 streamPort = 0;
+    quint16 metricsPort = 0;
+    // Shares the first --port
+    quint16 proxyPort = 0;
+  };
+
+  // Returns false and fills error if the arguments make no sense
+  static bool parseArguments(const QStringList &arguments, Options &options,
+                             QString &error);
+
+  static bool modeFromName(const QString &name, MeasurementMode &mode);
+
+  explicit HeadlessRunner(Options options, QObject *parent = nullptr);
+
+  ~HeadlessRunner() override;
+
+  void start();
+
+private slots:
+  void drain();
+
+private:
+  Options m_options;
+  InstrumentPool *m_instruments = nullptr;
+  QThread *m_recording_thread = nullptr;
+  std::vector<Recorder *> m_recorders;
+  QThread *m_network_thread = nullptr;
+  StreamServer *m_stream_server = nullptr;
+  // Meters still running; headless mode exits once none are left
+  std::size_t m_alive = 0;
+  // Per device; a failing port may report more than one error
+  std::vector<bool> m_failed;
+  // Shared by all meters, see InstrumentPool::attachRing
+  std::shared_ptr<ReadingRing> m_ring;
+  std::vector<Reading> m_batch;
+  QTimer *m_drain_timer = nullptr;
+  std::uint64_t m_overruns = 0;
+
+  [[nodiscard]] bool toStdout() const {
+    return m_options.out.isEmpty() || m_options.out == "-";
+  }
+
+  void onConnected(std::size_t device, const QString &portName,
+                   const QString &identity);
+
+  void onError(std::size_t device, const QString &message);
+
+  QString outputPath(std::size_t device) const;
+
+  void startNetworkServices();
+
+  void finish(int exitCode);
+};
+
+#endif // HEADLESSRUNNER_H
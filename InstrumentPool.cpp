@@ -0,0 +1,46 @@
+#include "InstrumentPool.h"
+
+InstrumentPool::InstrumentPool(QObject *parent)
+    : QObject(parent), m_epoch_ns(Reading::now()) {
+  m_thread = new QThread(this);
+  m_thread->setObjectName("acquisition");
+  m_thread->start();
+}
+
+InstrumentPool::~InstrumentPool() { shutdown(); }
+
+AcquisitionWorker *InstrumentPool::add() {
+  if (m_workers.size() >= kMaxInstruments || !m_thread->isRunning()) {
+    return nullptr;
+  }
+  auto *worker =
+      new AcquisitionWorker(static_cast<std::uint8_t>(m_workers.size()));
+  worker->moveToThread(m_thread);
+  connect(m_thread, &QThread::finished, worker, &QObject::deleteLater);
+  m_workers.push_back(worker);
+  return worker;
+}
+
+void InstrumentPool::attachRing(const std::shared_ptr<ReadingRing> &ring) {
+  for (auto *worker : m_workers) {
+    QMetaObject::invokeMethod(
+        worker, [worker, ring] { worker->attachRing(ring); },
+        Qt::QueuedConnection);
+  }
+}
+
+void InstrumentPool::detachRing(const std::shared_ptr<ReadingRing> &ring) {
+  for (auto *worker : m_workers) {
+    QMetaObject::invokeMethod(
+        worker, [worker, ring] { worker->detachRing(ring); },
+        Qt::QueuedConnection);
+  }
+}
+
+void InstrumentPool::shutdown() {
+  if (m_thread->isRunning()) {
+    m_thread->quit();
+    m_thread->wait();
+  }
+  m_workers.clear();
+}
@@ -0,0 +1,59 @@
+#ifndef INSTRUMENTPOOL_H
+#define INSTRUMENTPOOL_H
+
+#include <QObject>
+#include <QThread>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "AcquisitionWorker.h"
+
+// All meters of one process. Serial I/O is event driven, so a single
+// acquisition thread serves every worker; adding a meter costs a port, a
+// timer and a few rings rather than another thread, Qt instance and
+// settings store. Every reading carries its worker's index in
+// Reading::device and is stamped from the same steady clock, so readings
+// from different meters line up on one timeline.
+class InstrumentPool final : public QObject {
+  Q_OBJECT
+
+public:
+  static constexpr std::size_t kMaxInstruments = 32;
+
+  explicit InstrumentPool(QObject *parent = nullptr);
+
+  ~InstrumentPool() override;
+
+  // Creates the next worker on the acquisition thread. The port is not
+  // opened; queue openPort() on the returned worker for that. Returns
+  // nullptr once kMaxInstruments is reached.
+  AcquisitionWorker *add();
+
+  [[nodiscard]] std::size_t size() const { return m_workers.size(); }
+
+  [[nodiscard]] AcquisitionWorker *worker(std::size_t device) const {
+    return device < m_workers.size() ? m_workers[device] : nullptr;
+  }
+
+  // Timeline origin shared by all meters: the steady clock when the pool
+  // was created
+  [[nodiscard]] std::int64_t epochNs() const { return m_epoch_ns; }
+
+  // Since all producers run on the acquisition thread, one SPSC ring can
+  // take every meter's readings; the consumer sees them merged in arrival
+  // order. Queued, like every other call into the workers.
+  void attachRing(const std::shared_ptr<ReadingRing> &ring);
+
+  void detachRing(const std::shared_ptr<ReadingRing> &ring);
+
+  // Stops the acquisition thread; workers close their ports on the way out
+  void shutdown();
+
+private:
+  QThread *m_thread = nullptr;
+  std::vector<AcquisitionWorker *> m_workers;
+  std::int64_t m_epoch_ns;
+};
+
+#endif // INSTRUMENTPOOL_H
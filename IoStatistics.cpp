@@ -0,0 +1,85 @@
+#include "IoStatistics.h"
+
+#include <QJsonArray>
+
+LatencyHistogram &IoStatistics::latencyFor(const QString &command) {
+  for (auto &entry : commands) {
+    if (entry.command == command) {
+      return entry.latency;
+    }
+  }
+  if (commands.size() == kMaxCommands) {
+    commands.back().command = "(other)";
+    return commands.back().latency;
+  }
+  commands.push_back({command, {}});
+  return commands.back().latency;
+}
+
+void IoStatistics::reset() { *this = IoStatistics(); }
+
+static QString microseconds(const std::uint64_t ns) {
+  return QString::number(ns / 1000.0, 'f', 1);
+}
+
+QString IoStatistics::toText() const {
+  QString text;
+  text += QString("%1 %2 %3 %4 %5 %6 %7\n")
+              .arg("command", -14)
+              .arg("count", 9)
+              .arg("mean us", 10)
+              .arg("p50 us", 10)
+              .arg("p99 us", 10)
+              .arg("p99.9 us", 10)
+              .arg("max us", 10);
+  for (const auto &entry : commands) {
+    const LatencyHistogram &h = entry.latency;
+    text += QString("%1 %2 %3 %4 %5 %6 %7\n")
+                .arg(entry.command, -14)
+                .arg(h.count(), 9)
+                .arg(QString::number(h.mean() / 1000.0, 'f', 1), 10)
+                .arg(microseconds(h.percentile(50)), 10)
+                .arg(microseconds(h.percentile(99)), 10)
+                .arg(microseconds(h.percentile(99.9)), 10)
+                .arg(microseconds(h.max()), 10);
+  }
+  text += "\n";
+  text += QString("queries         %1\n").arg(queries);
+  text += QString("statements      %1\n").arg(statements);
+  text += QString("timeouts        %1\n").arg(timeouts);
+  text += QString("partial reads   %1\n").arg(partialReads);
+  text += QString("unsolicited     %1\n").arg(unsolicited);
+  text += QString("decode failures %1\n").arg(decodeFailures);
+  text += QString("bytes in        %1\n").arg(bytesIn);
+  text += QString("bytes out       %1\n").arg(bytesOut);
+  return text;
+}
+
+QJsonObject IoStatistics::toJson() const {
+  QJsonArray latencies;
+  for (const auto &entry : commands) {
+    const LatencyHistogram &h = entry.latency;
+    latencies.append(QJsonObject{
+        {"command", entry.command},
+        {"count", static_cast<qint64>(h.count())},
+        {"mean_ns", h.mean()},
+        {"min_ns", static_cast<qint64>(h.min())},
+        {"p50_ns", static_cast<qint64>(h.percentile(50))},
+        {"p90_ns", static_cast<qint64>(h.percentile(90))},
+        {"p99_ns", static_cast<qint64>(h.percentile(99))},
+        {"p99_9_ns", static_cast<qint64>(h.percentile(99.9))},
+        {"max_ns", static_cast<qint64>(h.max())},
+    });
+  }
+  return QJsonObject{
+      {"latency", latencies},
+      {"queries", static_cast<qint64>(queries)},
+      {"statements", static_cast<qint64>(statements)},
+      {"timeouts", static_cast<qint64>(timeouts)},
+      {"partial_reads", static_cast<qint64>(partialReads)},
+      {"unsolicited", static_cast<qint64>(unsolicited)},
+      {"decode_failures", static_cast<qint64>(decodeFailures)},
+      {"bytes_in", static_cast<qint64>(bytesIn)},
+      {"bytes_out", static_cast<qint64>(bytesOut)},
+  };
+}
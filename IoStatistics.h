@@ -0,0 +1,46 @@
+#ifndef IOSTATISTICS_H
+#define IOSTATISTICS_H
+
+#include <QJsonObject>
+#include <QMetaType>
+#include <QString>
+#include <vector>
+
+#include "LatencyHistogram.h"
+
+// Counters and per-command round-trip histograms for one SCPI link. Updated
+// by ScpiCommandQueue on every exchange, which costs well under a
+// microsecond; copied out to the GUI on request.
+struct IoStatistics {
+  // Query types beyond this share the last histogram
+  static constexpr std::size_t kMaxCommands = 16;
+
+  struct Command {
+    QString command;
+    LatencyHistogram latency;
+  };
+
+  std::vector<Command> commands;
+  quint64 queries = 0;
+  quint64 statements = 0;
+  quint64 timeouts = 0;
+  // readyRead ended with half a line in the buffer
+  quint64 partialReads = 0;
+  quint64 unsolicited = 0;
+  quint64 decodeFailures = 0;
+  quint64 bytesIn = 0;
+  quint64 bytesOut = 0;
+
+  LatencyHistogram &latencyFor(const QString &command);
+
+  void reset();
+
+  // Aligned table for the diagnostics panel and plain-text export
+  [[nodiscard]] QString toText() const;
+
+  [[nodiscard]] QJsonObject toJson() const;
+};
+
+Q_DECLARE_METATYPE(IoStatistics)
+
+#endif // IOSTATISTICS_H
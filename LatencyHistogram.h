@@ -0,0 +1,104 @@
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include <array>
+#include <cstdint>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// Log-linear histogram in the style of HdrHistogram: every power of two is
+// split into 32 linear buckets, so any recorded value is known to within about
+// 3% from 1 ns up to half an hour. Fixed size, no allocation, and
+// recording is a few instructions.
+class LatencyHistogram {
+public:
+  static constexpr int kSubBits = 5;
+  static constexpr int kSubBuckets = 1 << kSubBits;
+  static constexpr int kMaxExponent = 40; // clamps at 2^41 ns, ~36 minutes
+  static constexpr int kBuckets = (kMaxExponent - kSubBits + 2) * kSubBuckets;
+
+  void record(std::uint64_t valueNs) {
+    ++m_counts[indexOf(valueNs)];
+    ++m_count;
+    m_sum += valueNs;
+    if (valueNs < m_min || m_count == 1) {
+      m_min = valueNs;
+    }
+    if (valueNs > m_max) {
+      m_max = valueNs;
+    }
+  }
+
+  void reset() { *this = LatencyHistogram(); }
+
+  [[nodiscard]] std::uint64_t count() const { return m_count; }
+  [[nodiscard]] std::uint64_t min() const { return m_min; }
+  [[nodiscard]] std::uint64_t max() const { return m_max; }
+  [[nodiscard]] std::uint64_t sum() const { return m_sum; }
+  [[nodiscard]] double mean() const {
+    return m_count ? static_cast<double>(m_sum) / m_count : 0.0;
+  }
+
+  // Highest value that falls in the same bucket as the requested percentile
+  // (0..100); never under-reports
+  [[nodiscard]] std::uint64_t percentile(const double percent) const {
+    if (m_count == 0) {
+      return 0;
+    }
+    auto rank = static_cast<std::uint64_t>(percent / 100.0 * m_count + 0.5);
+    rank = rank < 1 ? 1 : rank > m_count ? m_count : rank;
+    std::uint64_t seen = 0;
+    for (int i = 0; i < kBuckets; ++i) {
+      seen += m_counts[i];
+      if (seen >= rank) {
+        const std::uint64_t upper = upperBound(i);
+        return upper < m_max ? upper : m_max;
+      }
+    }
+    return m_max;
+  }
+
+private:
+  std::array<std::uint64_t, kBuckets> m_counts{};
+  std::uint64_t m_count = 0;
+  std::uint64_t m_sum = 0;
+  std::uint64_t m_min = 0;
+  std::uint64_t m_max = 0;
+
+  static int indexOf(std::uint64_t value) {
+    if (value < kSubBuckets) {
+      return static_cast<int>(value);
+    }
+    int msb = highestBit(value);
+    if (msb > kMaxExponent) {
+      msb = kMaxExponent;
+      value = (std::uint64_t{2} << kMaxExponent) - 1;
+    }
+    const int shift = msb - kSubBits;
+    const int sub = static_cast<int>(value >> shift) & (kSubBuckets - 1);
+    return (msb - kSubBits + 1) * kSubBuckets + sub;
+  }
+
+  static std::uint64_t upperBound(const int index) {
+    if (index < kSubBuckets) {
+      return static_cast<std::uint64_t>(index);
+    }
+    const int shift = index / kSubBuckets - 1;
+    const int sub = index % kSubBuckets;
+    return ((static_cast<std::uint64_t>(kSubBuckets + sub + 1)) << shift) - 1;
+  }
+
+  static int highestBit(const std::uint64_t value) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+    return static_cast<int>(index);
+#else
+    return 63 - __builtin_clzll(value);
+#endif
+  }
+};
+
+#endif // LATENCYHISTOGRAM_H
@@ -1,8 +1,10 @@
 #include "MainWindow.h"
 
 #include "ConnectDialog.h"
+#include "ReadingFormat.h"
+#include <QDateTime>
 #include <QDebug>
-#include <QMouseEvent>
+#include <QFileDialog>
 #include <QThread>
 #include <QTimer>
 #include <QtWidgets/QApplication>
@@ -10,6 +12,8 @@
 #include <QtWidgets/QMainWindow>
 #include <QtWidgets/QPushButton>
 #include <QtWidgets/QWidget>
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 
 Settings *MainWindow::settings = nullptr;
@@ -30,23 +34,63 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent) { // NOLINT(*-pro-
 
   setupUi(this);
 
+  // One meter per window for now; the pool's thread would serve more
+  m_instruments = new InstrumentPool(this);
+  m_worker = m_instruments->add();
+  connect(m_worker, &AcquisitionWorker::connected, this,
+          &MainWindow::onConnect);
+  connect(m_worker, &AcquisitionWorker::errorOccurred, this,
+          &MainWindow::onSerialError);
+  connect(m_worker, &AcquisitionWorker::reconnecting, this,
+          &MainWindow::onReconnecting);
+  connect(m_worker, &AcquisitionWorker::reconnected, this,
+          &MainWindow::onReconnected);
+  // A bumped cable should not need anyone at the bench
+  QMetaObject::invokeMethod(
+      m_worker, [worker = m_worker] { worker->setAutoReconnect(true); },
+      Qt::QueuedConnection);
+  connect(m_worker, &AcquisitionWorker::throughputChanged, this,
+          &MainWindow::onThroughputChanged);
+  connect(m_worker, &AcquisitionWorker::statisticsChanged, this,
+          &MainWindow::onStatisticsChanged);
+
+  // The display only needs the latest value; it drains its ring at screen
+  // rate however fast the meter is polled.
+  m_display_ring = std::make_shared<ReadingRing>(1024);
+  QMetaObject::invokeMethod(
+      m_worker,
+      [worker = m_worker, ring = m_display_ring] { worker->attachRing(ring); },
+      Qt::QueuedConnection);
+  m_display_timer = new QTimer(this);
+  m_display_timer->setInterval(50);
+  connect(m_display_timer, &QTimer::timeout, this,
+          &MainWindow::drainReadings);
+  m_display_timer->start();
+
+  m_recording_thread = new QThread(this);
+  m_recorder = new Recorder;
+  m_recorder->moveToThread(m_recording_thread);
+  connect(m_recording_thread, &QThread::finished, m_recorder,
+          &QObject::deleteLater);
+  connect(m_recorder, &Recorder::errorOccurred, this,
+          &MainWindow::onRecordingError);
+  m_recording_thread->start();
+
+  startNetworkServices();
+
   QTimer::singleShot(2000, this, &MainWindow::connectSerial);
 }
 
 MainWindow::~MainWindow() {
   // No need to delete UI elements as they are deleted when parent is deleted
-  if (m_port) {
-    if (m_port->isOpen()) {
-      m_port->close();
-    }
-    delete m_port;
-    m_port = nullptr;
-  }
-
-  if (m_timer) {
-    m_timer->stop();
-    delete m_timer;
-    m_timer = nullptr;
+  // The worker closes its port when it is deleted on thread exit
+  m_instruments->shutdown();
+  // The recorder drains what is left and closes its file on deletion
+  m_recording_thread->quit();
+  m_recording_thread->wait();
+  if (m_network_thread) {
+    m_network_thread->quit();
+    m_network_thread->wait();
   }
 }
 
@@ -62,7 +106,8 @@ void MainWindow::setupUi(QMainWindow *MainWindow) {
   const auto centralwidget = new QWidget(MainWindow);
   centralwidget->setObjectName("centralwidget");
 
-  measurement = new QLabel("not connected", centralwidget);
+  measurement = new ReadingDisplay(centralwidget);
+  measurement->setText("not connected");
   measurement->setObjectName("measurement");
 
   QFont font;
@@ -83,18 +128,28 @@ void MainWindow::setupUi(QMainWindow *MainWindow) {
 
   measurement->setFrameShape(QFrame::StyledPanel);
   measurement->setFrameShadow(QFrame::Raised);
-  measurement->setTextFormat(Qt::PlainText);
-  measurement->setAlignment(Qt::AlignRight | Qt::AlignVCenter);
-  measurement->setMargin(0);
   measurement->setContentsMargins(0, 0, 0, 0);
-  measurement->setStyleSheet("QLabel { padding: 0px; margin: 0px; }");
 
-  measurement->installEventFilter(this);
+  connect(measurement, &ReadingDisplay::clicked, this,
+          &MainWindow::onMeasurementClicked);
 
   measurement->setMouseTracking(true);
   measurement->setAttribute(Qt::WA_Hover, true);
   measurement->setFocusPolicy(Qt::StrongFocus);
 
+  m_secondary_label = new QLabel(centralwidget);
+  m_secondary_label->setObjectName("secondary");
+  m_secondary_label->setTextFormat(Qt::PlainText);
+  m_secondary_label->setAlignment(Qt::AlignRight | Qt::AlignVCenter);
+  QFont secondaryFont = font;
+  secondaryFont.setPointSize(24);
+  m_secondary_label->setFont(secondaryFont);
+
+  m_stats_label = new QLabel(centralwidget);
+  m_stats_label->setObjectName("stats");
+  m_stats_label->setTextFormat(Qt::PlainText);
+  m_stats_label->setAlignment(Qt::AlignRight | Qt::AlignVCenter);
+
   btn_50_v = new QPushButton("50 V", centralwidget);
   btn_50_v->setObjectName("btn_50_v");
 
@@ -125,6 +180,16 @@ void MainWindow::setupUi(QMainWindow *MainWindow) {
   btn_period = new QPushButton("Period", centralwidget);
   btn_period->setObjectName("btn_period");
 
+  m_chart = new TrendChart(centralwidget);
+  m_chart->setObjectName("chart");
+
+  btn_record = new QPushButton("Rec", centralwidget);
+  btn_record->setObjectName("btn_record");
+  btn_record->setCheckable(true);
+
+  btn_diagnostics = new QPushButton("Diag", centralwidget);
+  btn_diagnostics->setObjectName("btn_diagnostics");
+
   connect(btn_50_v, &QPushButton::clicked, this, &MainWindow::onVoltage50V);
   connect(btn_auto_v, &QPushButton::clicked, this, &MainWindow::onVoltageAuto);
   connect(btn_short, &QPushButton::clicked, this, &MainWindow::onShort);
@@ -138,17 +203,15 @@ void MainWindow::setupUi(QMainWindow *MainWindow) {
           &MainWindow::onCapacitanceAuto);
   connect(btn_freq, &QPushButton::clicked, this, &MainWindow::onFrequency);
   connect(btn_period, &QPushButton::clicked, this, &MainWindow::onPeriod);
+  connect(btn_record, &QPushButton::toggled, this,
+          &MainWindow::onRecordToggled);
+  connect(btn_diagnostics, &QPushButton::clicked, this,
+          &MainWindow::onDiagnostics);
 
   setupPositions(MainWindow->width(), MainWindow->height());
   MainWindow->setCentralWidget(centralwidget);
 
   m_connect_dialog = new ConnectDialog(this);
-
-  this->m_timer = new QTimer(this);
-  this->m_timer->setInterval(100);
-  this->m_timer->setSingleShot(false);
-  connect(this->m_timer, &QTimer::timeout, this,
-          &MainWindow::updateMeasurement);
 }
 
 void MainWindow::resizeEvent(QResizeEvent *event) {
@@ -162,14 +225,22 @@ void MainWindow::resizeEvent(QResizeEvent *event) {
 void MainWindow::setupPositions(const int width, const int height) const {
   const int btn_width = 70;
   const int btn_height = 32;
-  const int btnbar_w = 350;
+  const int btnbar_w = 420;
   const int btn_x = (width - btnbar_w) / 2;
   //std::cerr << "w=" << width << " h=" << height << std::endl;
 
   auto measureHeight = measurement->fontMetrics().height();
   // max width
   measurement->setGeometry(QRect(2, 0, width - 4, measureHeight));
-  const int btngroup_y1 = measurement->y() + measurement->height() + 2;
+  // Keeps its space when empty so the buttons don't jump around
+  const int secondaryHeight = m_secondary_label->fontMetrics().height();
+  m_secondary_label->setGeometry(QRect(2, measurement->y() + measureHeight,
+                                       width - 4, secondaryHeight));
+  const int statsHeight = m_stats_label->fontMetrics().height();
+  m_stats_label->setGeometry(
+      QRect(2, m_secondary_label->y() + m_secondary_label->height(),
+            width - 4, statsHeight));
+  const int btngroup_y1 = m_stats_label->y() + m_stats_label->height() + 2;
   const int btngroup_y2 = btngroup_y1 + btn_height + 1;
 
   btn_50_v->setGeometry(QRect(btn_x, btngroup_y1, btn_width, btn_height));
@@ -186,6 +257,16 @@ void MainWindow::setupPositions(const int width, const int height) const {
   btn_freq->setGeometry(QRect(btn_x + 280, btngroup_y1, btn_width, btn_height));
   btn_period->setGeometry(
       QRect(btn_x + 280, btngroup_y2, btn_width, btn_height));
+  btn_record->setGeometry(
+      QRect(btn_x + 350, btngroup_y1, btn_width, btn_height));
+  btn_diagnostics->setGeometry(
+      QRect(btn_x + 350, btngroup_y2, btn_width, btn_height));
+
+  // The chart gets whatever height is left below the buttons
+  const int chart_y = btngroup_y2 + btn_height + 4;
+  const int chart_height = height - chart_y - 2;
+  m_chart->setVisible(chart_height >= 40);
+  m_chart->setGeometry(QRect(2, chart_y, width - 4, chart_height));
 }
 
 void MainWindow::connectSerial() {
@@ -193,235 +274,357 @@ void MainWindow::connectSerial() {
   if (MainWindow::settings->device().isEmpty()) {
     this->openConnectDialog();
   } else {
-    if (!this->m_connect_dialog->tryPortByName(
-            MainWindow::settings->device())) {
-      std::cerr << "Could not connect to serial port "
-                << MainWindow::settings->device().toStdString() << std::endl;
-    } else {
-      this->m_port = m_connect_dialog->getConfiguredSerialPort();
-      this->onConnect();
-    }
+    // The worker probes the port with *IDN? and reports back via connected()
+    // or errorOccurred()
+    this->connectDevice(MainWindow::settings->device());
   }
 }
 
-QString MainWindow::rateToSerial(Settings::Rate rate) {
-  switch (rate) {
-  case Settings::Rate::SLOW:
-    return "S";
-  case Settings::Rate::MEDIUM:
-    return "M";
-  case Settings::Rate::FAST:
-    return "F";
-  }
-  return "F";
+void MainWindow::connectDevice(const QString &portName) const {
+  QMetaObject::invokeMethod(
+      m_worker, [worker = m_worker, portName] { worker->openPort(portName); },
+      Qt::QueuedConnection);
 }
 
-void MainWindow::onConnect() {
-  this->writeSCPIStatement(
-      QString("RATE " + rateToSerial(settings->getRate())));
-
-  this->writeSCPIStatement("SYST:BEEP:STAT OFF");
-  this->onVoltage50V();
-
-  this->m_timer->start();
+void MainWindow::onConnect(const QString &portName, const QString &identity) {
+  std::cerr << "Connected to " << identity.toStdString() << " on "
+            << portName.toStdString() << std::endl;
+  m_connected = true;
+  m_identity = identity;
+  m_port_name = portName;
+  // The worker has read back what the meter is set to, so this only sends
+  // what differs
+  this->configureMode(settings->lastMode(portName),
+                      settings->lastRange(portName));
+
+  QMetaObject::invokeMethod(
+      m_worker, [worker = m_worker] { worker->startAdaptivePolling(); },
+      Qt::QueuedConnection);
 }
 
 bool MainWindow::openConnectDialog() {
   if (m_connect_dialog->exec() == QDialog::Accepted) {
-    const auto serialPort = m_connect_dialog->getConfiguredSerialPort();
-    if (serialPort) {
-      MainWindow::settings->setDevice(serialPort->portName());
+    // The dialog has closed its probe ports; the acquisition thread opens
+    // its own QSerialPort for the device
+    const QString portName = m_connect_dialog->getSelectedPort();
+    if (!portName.isEmpty()) {
+      MainWindow::settings->setDevice(portName);
+      this->connectDevice(portName);
       return true;
     }
-    this->m_port = serialPort;
   }
   return false;
 }
 
-void MainWindow::updateMeasurement() {
-  if (!this->m_port) {
-    std::cerr << "Port is NULL, stopping timer" << std::endl;
-    this->m_timer->stop();
-    this->m_timer->deleteLater();
-    this->m_timer = nullptr;
+void MainWindow::drainReadings() {
+  Reading reading;
+  bool any = false;
+  while (m_display_ring->pop(reading)) {
+    m_chart->addReading(reading);
+    any = true;
+  }
+  if (any) {
+    updateMeasurement(reading);
+    m_chart->update();
+  }
+
+  if (const auto overruns = m_display_ring->overruns();
+      overruns != m_display_overruns) {
+    std::cerr << "Display fell behind, " << overruns - m_display_overruns
+              << " readings dropped" << std::endl;
+    m_display_overruns = overruns;
+  }
+}
+
+void MainWindow::onThroughputChanged(const double samplesPerSecond,
+                                     const double meterUpdateHz) {
+  setWindowTitle(QString("MacWake OWON XDM-1041 - %1 S/s (meter %2 Hz)")
+                     .arg(samplesPerSecond, 0, 'f', 1)
+                     .arg(meterUpdateHz, 0, 'f', 1));
+}
+
+void MainWindow::onStatisticsChanged(const RunningStats::Snapshot &statistics,
+                                     const Unit unit) {
+  if (statistics.session.count == 0) {
+    m_stats_label->clear();
     return;
   }
-  auto reading = this->writeSCPICommand("MEAS1:SHOW?");
+  auto format = [unit](const double value) {
+    Reading reading;
+    reading.value = value;
+    reading.unit = unit;
+    return formatReading(reading);
+  };
+  const RunningStats::Summary &all = statistics.session;
+  const RunningStats::Summary &recent = statistics.window;
+  m_stats_label->setText(
+      QString("n %1  min %2  max %3  mean %4  σ %5    last %6: mean %7  σ %8")
+          .arg(all.count)
+          .arg(format(all.min), format(all.max), format(all.mean),
+               format(all.stddev))
+          .arg(recent.count)
+          .arg(format(recent.mean), format(recent.stddev)));
+}
 
-  QString display = reading.replace("\u00a6\u00b8", "Ω Ohm")
-                        .replace("\u00aa\u00cc", "µ")
-                        .replace("\u00a1\u00e6", "°C")
-                        .replace("\u00a8\u0048", "°F");
-  this->measurement->setText(display);
+void MainWindow::updateMeasurement(const Reading &reading) {
+  this->measurement->setText(formatReading(reading));
+  if (!reading.hasSecondary) {
+    m_secondary_label->clear();
+    return;
+  }
+  Reading secondary;
+  secondary.value = reading.secondary;
+  secondary.unit = reading.secondaryUnit;
+  secondary.overload = reading.secondaryOverload;
+  const QString text = formatReading(secondary);
+  // QLabel relayouts on every setText, even an identical one
+  if (m_secondary_label->text() != text) {
+    m_secondary_label->setText(text);
+  }
 }
 
 void MainWindow::onVoltage50V() {
-  this->m_unit = "V";
-  this->writeSCPIStatement("CONF:VOLT:DC 50");
+  this->configureMode(MeasurementMode::VoltageDC, "50");
 }
 
 void MainWindow::onVoltageAuto() {
-  this->m_unit = "V";
-  this->writeSCPIStatement("CONF:VOLT:DC AUTO");
+  this->configureMode(MeasurementMode::VoltageDC, "AUTO");
 }
 
 void MainWindow::onShort() {
-  this->m_unit = "Ω";
-  this->writeSCPIStatement("CONF:CONT");
-  if (settings->getBeepShort()) {
-    qDebug() << "Beep resistance: " << MainWindow::settings->getBeepResistance();
-    this->writeSCPIStatement(QString("CONT:THRE ") +
-                        QString::number(MainWindow::settings->getBeepResistance()));
-    this->writeSCPIStatement("SYST:BEEP:STAT ON");
-  } else {
-    this->writeSCPIStatement("SYST:BEEP:STAT OFF");
-  }
+  this->configureMode(MeasurementMode::Continuity);
 }
 
-void MainWindow::onDiode() {
-  if (MainWindow::settings->getBeepDiode()) {
-    this->writeSCPIStatement("SYST:BEEP:STAT ON");
-  } else {
-    this->writeSCPIStatement("SYST:BEEP:STAT OFF");
-  }
-  this->writeSCPIStatement("CONF:DIOD");
-}
+void MainWindow::onDiode() { this->configureMode(MeasurementMode::Diode); }
 
 void MainWindow::onResistance50K() {
-  this->writeSCPIStatement("CONF:RES 50E3");
+  this->configureMode(MeasurementMode::Resistance, "50E3");
 }
 
 void MainWindow::onResistanceAuto() {
-  this->m_unit = "Ω";
-  this->writeSCPIStatement("CONF:RES AUTO");
+  this->configureMode(MeasurementMode::Resistance, "AUTO");
 }
 
 void MainWindow::onCapacitance50uF() {
-  this->m_unit = "F";
-  this->writeSCPIStatement("CONF:CAP 50E-6");
+  this->configureMode(MeasurementMode::Capacitance, "50E-6");
 }
 
 void MainWindow::onCapacitanceAuto() {
-  this->m_unit = "F";
-  this->writeSCPIStatement("CONF:CAP AUTO");
+  this->configureMode(MeasurementMode::Capacitance, "AUTO");
 }
 
 void MainWindow::onFrequency() {
-  this->m_unit = "Hz";
-  this->writeSCPIStatement("CONF:FREQ");
+  this->configureMode(MeasurementMode::Frequency);
 }
 
 void MainWindow::onPeriod() {
-  this->m_unit = "%";
-  this->writeSCPIStatement("CONF:PER");
+  this->configureMode(MeasurementMode::Period);
 }
 
 void MainWindow::onSerialError(const QString &message) {
-  if (this->m_timer) {
-    this->m_timer->stop();
-    qDebug() << "Stopping timer";
-  }
+  // The worker has already stopped polling and closed its port
   qDebug() << "Serial port error: " << message;
   std::cerr << "Serial port error, closing\n";
-  if (this->m_port) {
-    if (this->m_port->isOpen()) {
-      this->m_port->close();
-    }
-    delete this->m_port;
-    this->m_port = nullptr;
-  }
+  m_connected = false;
+  this->measurement->setText("not connected");
+  m_secondary_label->clear();
+  setWindowTitle("MacWake OWON XDM-1041");
 }
 
-QString MainWindow::readSCPI() const {
-  if (!m_port || !m_port->isOpen()) {
-    qDebug() << "Serial port not open";
-    return {};
-  }
-
-  if (!m_port->waitForReadyRead(500)) {
-    qDebug() << "Serial port not ready";
-    return {};
-  }
-
-  QByteArray responseData;
-  QElapsedTimer timer;
-  timer.start();
+void MainWindow::onReconnecting(const QString &portName) {
+  // Recording goes on; the worker marks the gap in the data
+  m_connected = false;
+  this->measurement->setText("reconnecting");
+  m_secondary_label->clear();
+  setWindowTitle("MacWake OWON XDM-1041 - reconnecting to " + portName);
+}
 
-  while (!responseData.contains('\n')) {
-    if (timer.elapsed() > 100) {
-      qDebug() << "Read timeout occurred";
-      // emit onSerialError("readSCPI timeout");
-      return {};
-    }
+void MainWindow::onReconnected(const QString &portName,
+                               const qint64 downtimeMs) {
+  // The worker has logged the downtime already
+  Q_UNUSED(downtimeMs)
+  m_connected = true;
+  m_port_name = portName;
+  setWindowTitle("MacWake OWON XDM-1041");
+}
 
-    if (m_port->bytesAvailable() > 0) {
-      responseData.append(m_port->readAll());
-    } else {
-      QThread::msleep(10);
-    }
+void MainWindow::configureMode(const MeasurementMode mode,
+                               const QString &range) {
+  if (!m_connected) {
+    std::cerr << "No port open, refusing writeSCPI\n";
+    return;
   }
+  m_mode = mode;
+  m_range = range;
+  settings->setLastMode(m_port_name, mode, range);
+  QMetaObject::invokeMethod(
+      m_worker,
+      [worker = m_worker, wanted = wantedState(mode, range)] {
+        worker->apply(wanted);
+      },
+      Qt::QueuedConnection);
+}
 
-  QString response = QString::fromLatin1(responseData);
-  QByteArray data = response.toLatin1();
-
-  if (data.contains(QByteArray("\xa6\xb8", 2))) {
-    data.replace(QByteArray("\xa6\xb8", 2), "Ω");
+MeterState MainWindow::wantedState(const MeasurementMode mode,
+                                   const QString &range) const {
+  const auto device = settings->deviceSettings(m_port_name);
+  MeterState wanted;
+  wanted.mode = mode;
+  if (!range.isEmpty()) {
+    wanted.range = range;
   }
-  if (data.contains(QByteArray("\xa6\xcc", 2))) {
-    data.replace(QByteArray("\xa6\xcc", 2), "µ");
+  wanted.rate = device.rate;
+  // Beeping only makes sense where the meter beeps on a condition
+  switch (mode) {
+  case MeasurementMode::Continuity:
+    wanted.beep = device.beepShort;
+    if (device.beepShort) {
+      wanted.threshold = device.beepResistance;
+    }
+    break;
+  case MeasurementMode::Diode:
+    wanted.beep = device.beepDiode;
+    break;
+  default:
+    wanted.beep = false;
+    break;
   }
-  if (data.contains(QByteArray("\xa1\xe6", 2))) {
-    data.replace(QByteArray("\xa1\xe6", 2), "°C");
+  return wanted;
+}
+
+void MainWindow::onRecordToggled(const bool checked) {
+  if (!checked) {
+    QMetaObject::invokeMethod(
+        m_worker,
+        [worker = m_worker, ring = m_recorder->ring()] {
+          worker->detachRing(ring);
+        },
+        Qt::QueuedConnection);
+    QMetaObject::invokeMethod(m_recorder, &Recorder::stop,
+                              Qt::QueuedConnection);
+    return;
   }
-  if (data.contains(QByteArray("\xa8\x48", 2))) {
-    data.replace(QByteArray("\xa8\x48", 2), "°F");
+
+  const QString suggested =
+      "owon-" + QDateTime::currentDateTime().toString("yyyyMMdd-HHmmss") +
+      ".owr";
+  const QString path = QFileDialog::getSaveFileName(
+      this, "Record to", suggested, "OWON recordings (*.owr)");
+  if (path.isEmpty()) {
+    const QSignalBlocker blocker(btn_record);
+    btn_record->setChecked(false);
+    return;
   }
-  response = QString::fromUtf8(data);
-  QRegularExpression re("([-+]?[0-9]*\\.?[0-9]+)([^0-9.]+)");
-  response = response.replace(re, "\\1 \\2");
 
-  response = response.replace("  ", " ");
+  RecordingHeader header = RecordingHeader::make();
+  header.mode = static_cast<std::uint8_t>(m_mode);
+  header.rate =
+      static_cast<std::uint8_t>(settings->deviceSettings(m_port_name).rate);
+  header.startTimestampNs = Reading::now();
+  header.startEpochMs = QDateTime::currentMSecsSinceEpoch();
+  const QByteArray identity = m_identity.toLatin1();
+  std::memcpy(header.identity, identity.constData(),
+              std::min<std::size_t>(identity.size(), sizeof(header.identity) - 1));
+  const QByteArray range = m_range.toLatin1();
+  std::memcpy(header.range, range.constData(),
+              std::min<std::size_t>(range.size(), sizeof(header.range) - 1));
+
+  QMetaObject::invokeMethod(
+      m_recorder,
+      [recorder = m_recorder, path, header] { recorder->start(path, header); },
+      Qt::QueuedConnection);
+  QMetaObject::invokeMethod(
+      m_worker,
+      [worker = m_worker, ring = m_recorder->ring()] {
+        worker->attachRing(ring);
+      },
+      Qt::QueuedConnection);
+}
 
-  return response;
+void MainWindow::onRecordingError(const QString &message) {
+  std::cerr << message.toStdString() << std::endl;
+  const QSignalBlocker blocker(btn_record);
+  btn_record->setChecked(false);
+  QMetaObject::invokeMethod(
+      m_worker,
+      [worker = m_worker, ring = m_recorder->ring()] {
+        worker->detachRing(ring);
+      },
+      Qt::QueuedConnection);
 }
 
-void MainWindow::writeSCPIStatement(const QString &command) const {
-  if (!this->m_port) {
-    std::cerr << "No port open, refusing writeSCPI\n";
+void MainWindow::startNetworkServices() {
+  const QHostAddress address(settings->listenAddress());
+  if (settings->streamPort() <= 0 && settings->metricsPort() <= 0 &&
+      settings->proxyPort() <= 0) {
     return;
   }
-  // qDebug() << "Writing " << command;
-  this->m_port->write(QString(command + "\r\n").toLocal8Bit());
-  this->m_port->flush();
-  QThread::msleep(10);
-}
+  // Sockets get a thread of their own so clients never wait on the GUI
+  m_network_thread = new QThread(this);
+  m_network_thread->setObjectName("network");
+
+  if (settings->streamPort() > 0) {
+    m_stream_server = new StreamServer;
+    m_stream_server->moveToThread(m_network_thread);
+    connect(m_network_thread, &QThread::finished, m_stream_server,
+            &QObject::deleteLater);
+    m_instruments->attachRing(m_stream_server->ring());
+    QMetaObject::invokeMethod(
+        m_stream_server,
+        [server = m_stream_server, address,
+         port = static_cast<quint16>(settings->streamPort()),
+         epoch = m_instruments->epochNs()] {
+          server->listen(address, port, epoch);
+        },
+        Qt::QueuedConnection);
+  }
 
-QString MainWindow::writeSCPICommand(const QString &command) const {
-  if (!this->m_port) {
-    std::cerr << "No port open, refusing writeSCPI\n";
-    return nullptr;
+  if (settings->metricsPort() > 0) {
+    auto *metrics = new MetricsServer;
+    for (std::size_t i = 0; i < m_instruments->size(); ++i) {
+      metrics->addDevice(m_instruments->worker(i)->metrics());
+    }
+    metrics->addRing("display", m_display_ring);
+    metrics->addRing("recorder", m_recorder->ring());
+    if (m_stream_server) {
+      metrics->addRing("stream", m_stream_server->ring());
+    }
+    metrics->moveToThread(m_network_thread);
+    connect(m_network_thread, &QThread::finished, metrics,
+            &QObject::deleteLater);
+    QMetaObject::invokeMethod(
+        metrics,
+        [metrics, address,
+         port = static_cast<quint16>(settings->metricsPort())] {
+          metrics->listen(address, port);
+        },
+        Qt::QueuedConnection);
   }
-  // qDebug() << "Writing " << command;
-  this->m_port->write(QString(command + "\r\n").toLocal8Bit());
-  this->m_port->flush();
-  QThread::msleep(10);
-  return readSCPI();
+
+  if (settings->proxyPort() > 0) {
+    auto *proxy = new ScpiProxy(m_worker);
+    proxy->moveToThread(m_network_thread);
+    connect(m_network_thread, &QThread::finished, proxy,
+            &QObject::deleteLater);
+    QMetaObject::invokeMethod(
+        proxy,
+        [proxy, address, port = static_cast<quint16>(settings->proxyPort())] {
+          proxy->listen(address, port);
+        },
+        Qt::QueuedConnection);
+  }
+
+  m_network_thread->start();
 }
 
-bool MainWindow::eventFilter(QObject *obj, QEvent *event) {
-  if (obj == measurement) {
-    if (event->type() == QEvent::MouseButtonRelease) {
-      if (const QMouseEvent *mouseEvent = dynamic_cast<QMouseEvent *>(event);
-          mouseEvent->button() == Qt::LeftButton) {
-        onMeasurementClicked();
-        return true;
-      }
-    }
+void MainWindow::onDiagnostics() {
+  if (!m_diagnostics_dialog) {
+    m_diagnostics_dialog = new DiagnosticsDialog(m_worker, this);
   }
-  return QMainWindow::eventFilter(obj, event);
+  m_diagnostics_dialog->show();
+  m_diagnostics_dialog->raise();
 }
 
 void MainWindow::onMeasurementClicked() {
-  MainWindow::settings->save();
   openConnectDialog();
 }
\ No newline at end of file
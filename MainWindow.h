@@ -3,9 +3,21 @@
 
 #include <QLabel>
 #include <QMainWindow>
+#include <QThread>
+#include <QTimer>
+#include <memory>
 
+#include "AcquisitionWorker.h"
 #include "ConnectDialog.h"
+#include "DiagnosticsDialog.h"
+#include "InstrumentPool.h"
+#include "MetricsServer.h"
+#include "ReadingDisplay.h"
+#include "ScpiProxy.h"
+#include "StreamServer.h"
+#include "Recorder.h"
 #include "Settings.h"
+#include "TrendChart.h"
 
 class MainWindow final : public QMainWindow {
   Q_OBJECT
@@ -47,21 +59,41 @@ private slots:
 
   void onSerialError(const QString &message);
 
-  [[nodiscard]] QString readSCPI() const;
+  void onReconnecting(const QString &portName);
 
-  void writeSCPIStatement(const QString &command) const;
+  void onReconnected(const QString &portName, qint64 downtimeMs);
 
-  QString writeSCPICommand(const QString &command) const; // NOLINT(*-use-nodiscard)
+  void configureMode(MeasurementMode mode, const QString &range = {});
+
+  // Everything the meter should be set to for this function, from the
+  // per-device settings
+  MeterState wantedState(MeasurementMode mode, const QString &range) const;
 
-  bool eventFilter(QObject *obj, QEvent *event) override;
 
   void onMeasurementClicked();
 
-  void updateMeasurement(); // Make sure this exists and is declared as a slot
+  void drainReadings();
+
+  void onThroughputChanged(double samplesPerSecond, double meterUpdateHz);
+
+  void onStatisticsChanged(const RunningStats::Snapshot &statistics, Unit unit);
+
+  void updateMeasurement(const Reading &reading);
+
+  void onConnect(const QString &portName, const QString &identity);
+
+  void onRecordToggled(bool checked);
+
+  void onRecordingError(const QString &message);
+
+  void onDiagnostics();
 
 private:
   // UI elements as member variables (excluding centralwidget)
-  QLabel *measurement;
+  ReadingDisplay *measurement;
+  // Secondary display of the meter, e.g. frequency in AC modes
+  QLabel *m_secondary_label;
+  QLabel *m_stats_label;
   QPushButton *btn_50_v;
   QPushButton *btn_auto_v;
   QPushButton *btn_short;
@@ -72,20 +104,39 @@ private:
   QPushButton *btn_auto_f;
   QPushButton *btn_freq;
   QPushButton *btn_period;
+  QPushButton *btn_record;
+  QPushButton *btn_diagnostics;
+  TrendChart *m_chart;
 
   ConnectDialog *m_connect_dialog;
-  QString m_unit;
+  DiagnosticsDialog *m_diagnostics_dialog = nullptr;
 
   void connectSerial();
 
-  static QString rateToSerial(Settings::Rate rate);
-
-  void onConnect();
+  void connectDevice(const QString &portName) const;
 
   bool openConnectDialog();
 
-  QTimer *m_timer = nullptr;
-  QSerialPort *m_port = nullptr;
+  InstrumentPool *m_instruments = nullptr;
+  AcquisitionWorker *m_worker = nullptr;
+  bool m_connected = false;
+  std::shared_ptr<ReadingRing> m_display_ring;
+  std::uint64_t m_display_overruns = 0;
+  QTimer *m_display_timer = nullptr;
+
+  QString m_identity;
+  QString m_port_name;
+  MeasurementMode m_mode = MeasurementMode::Unknown;
+  QString m_range;
+
+  QThread *m_recording_thread = nullptr;
+  Recorder *m_recorder = nullptr;
+
+  // Only created when a network service is enabled in the settings
+  QThread *m_network_thread = nullptr;
+  StreamServer *m_stream_server = nullptr;
+
+  void startNetworkServices();
 };
 
 #endif // MAINWINDOW_H
@@ -0,0 +1,81 @@
+#include "MeterState.h"
+
+#include <map>
+
+void MeterState::merge(const MeterState &other) {
+  if (other.mode) {
+    mode = other.mode;
+  }
+  if (other.range) {
+    range = other.range;
+  }
+  if (other.rate) {
+    rate = other.rate;
+  }
+  if (other.beep) {
+    beep = other.beep;
+  }
+  if (other.threshold) {
+    threshold = other.threshold;
+  }
+}
+
+void MeterState::forget(const QString &statement) {
+  const QString upper = statement.trimmed().toUpper();
+  if (upper.startsWith("CONF")) {
+    mode.reset();
+    range.reset();
+  } else if (upper.startsWith("RATE")) {
+    rate.reset();
+  } else if (upper.startsWith("SYST:BEEP")) {
+    beep.reset();
+  } else if (upper.startsWith("CONT:THRE")) {
+    threshold.reset();
+  }
+}
+
+bool MeterState::takesRange(const MeasurementMode mode) {
+  switch (mode) {
+  case MeasurementMode::VoltageDC:
+  case MeasurementMode::VoltageAC:
+  case MeasurementMode::CurrentDC:
+  case MeasurementMode::CurrentAC:
+  case MeasurementMode::Resistance:
+  case MeasurementMode::Capacitance:
+  case MeasurementMode::Temperature:
+    return true;
+  default:
+    return false;
+  }
+}
+
+bool MeterState::sameRange(const QString &a, const QString &b) {
+  if (a.compare(b, Qt::CaseInsensitive) == 0) {
+    return true;
+  }
+  bool okA = false;
+  bool okB = false;
+  const double valueA = a.toDouble(&okA);
+  const double valueB = b.toDouble(&okB);
+  return okA && okB && valueA == valueB;
+}
+
+MeasurementMode MeterState::modeFromFunction(const QString &response) {
+  static const std::map<QString, MeasurementMode> functions = {
+      {"VOLT", MeasurementMode::VoltageDC},
+      {"VOLT AC", MeasurementMode::VoltageAC},
+      {"CURR", MeasurementMode::CurrentDC},
+      {"CURR AC", MeasurementMode::CurrentAC},
+      {"RES", MeasurementMode::Resistance},
+      {"CONT", MeasurementMode::Continuity},
+      {"DIOD", MeasurementMode::Diode},
+      {"CAP", MeasurementMode::Capacitance},
+      {"FREQ", MeasurementMode::Frequency},
+      {"PER", MeasurementMode::Period},
+      {"TEMP", MeasurementMode::Temperature},
+  };
+  QString name = response.trimmed().toUpper();
+  name.remove('"');
+  const auto it = functions.find(name);
+  return it != functions.end() ? it->second : MeasurementMode::Unknown;
+}
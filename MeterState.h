@@ -0,0 +1,38 @@
+#ifndef METERSTATE_H
+#define METERSTATE_H
+
+#include <QString>
+#include <optional>
+
+#include "Reading.h"
+#include "Settings.h"
+
+// The parts of the meter's configuration the app sets. The worker keeps one
+// of these as a shadow of what the meter currently has (empty fields are
+// unknown) and compares each requested state against it (empty fields are
+// left alone), so only the commands that change something go out.
+struct MeterState {
+  std::optional<MeasurementMode> mode;
+  // Ignored for functions without ranges, see takesRange()
+  std::optional<QString> range;
+  std::optional<Settings::Rate> rate;
+  std::optional<bool> beep;
+  std::optional<int> threshold; // continuity, in ohms
+
+  // Takes over every field that is set in other
+  void merge(const MeterState &other);
+
+  // We can't tell what a raw statement did; forget whatever it may touch
+  void forget(const QString &statement);
+
+  static bool takesRange(MeasurementMode mode);
+
+  // "50" and "5.000E+01" are the same range
+  static bool sameRange(const QString &a, const QString &b);
+
+  // Parses a FUNC? response such as "VOLT AC" (quotes optional); Unknown if
+  // it is not one we use
+  static MeasurementMode modeFromFunction(const QString &response);
+};
+
+#endif // METERSTATE_H
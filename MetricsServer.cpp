@@ -0,0 +1,181 @@
+#include "MetricsServer.h"
+
+#include <QTcpSocket>
+#include <cstdio>
+#include <iostream>
+#include <limits>
+
+MetricsServer::MetricsServer(QObject *parent) : QObject(parent) {}
+
+void MetricsServer::addDevice(
+    std::shared_ptr<const AcquisitionMetrics> metrics) {
+  m_devices.push_back(std::move(metrics));
+}
+
+void MetricsServer::addRing(const QString &name,
+                            std::shared_ptr<const ReadingRing> ring) {
+  m_rings.push_back({name, std::move(ring)});
+}
+
+void MetricsServer::listen(const QHostAddress &address, const quint16 port) {
+  m_server = new QTcpServer(this);
+  if (!m_server->listen(address, port)) {
+    const QString message = "Could not listen on " + address.toString() + ":" +
+                            QString::number(port) + ": " +
+                            m_server->errorString();
+    delete m_server;
+    m_server = nullptr;
+    emit errorOccurred(message);
+    return;
+  }
+  connect(m_server, &QTcpServer::newConnection, this,
+          &MetricsServer::onNewConnection);
+  std::cerr << "Serving metrics on http://" << address.toString().toStdString()
+            << ":" << m_server->serverPort() << "/metrics" << std::endl;
+}
+
+void MetricsServer::onNewConnection() {
+  while (QTcpSocket *socket = m_server->nextPendingConnection()) {
+    connect(socket, &QTcpSocket::disconnected, socket,
+            &QObject::deleteLater);
+    connect(socket, &QTcpSocket::readyRead, this, [this, socket] {
+      // Only the request line matters; wait until it is complete
+      if (!socket->canReadLine()) {
+        if (socket->bytesAvailable() > 4096) {
+          socket->abort();
+        }
+        return;
+      }
+      const QList<QByteArray> request = socket->readLine().split(' ');
+      QByteArray status = "404 Not Found";
+      QByteArray body = "Not found\n";
+      if (request.size() >= 2 && request[0] == "GET" &&
+          (request[1] == "/metrics" || request[1].startsWith("/metrics?"))) {
+        status = "200 OK";
+        body = render();
+      }
+      socket->write("HTTP/1.0 " + status +
+                    "\r\nContent-Type: text/plain; version=0.0.4\r\n"
+                    "Content-Length: " +
+                    QByteArray::number(body.size()) +
+                    "\r\nConnection: close\r\n\r\n" + body);
+      socket->disconnectFromHost();
+    });
+  }
+}
+
+QByteArray MetricsServer::render() const {
+  QByteArray out;
+  out.reserve(4096);
+  char line[160];
+  const auto emitHeader = [&out](const char *name, const char *type,
+                                 const char *help) {
+    out += "# HELP ";
+    out += name;
+    out += ' ';
+    out += help;
+    out += "\n# TYPE ";
+    out += name;
+    out += ' ';
+    out += type;
+    out += '\n';
+  };
+  // One line per device for the given accessor
+  const auto perDevice = [&](const char *name, const char *type,
+                             const char *help, auto value) {
+    emitHeader(name, type, help);
+    for (std::size_t i = 0; i < m_devices.size(); ++i) {
+      std::snprintf(line, sizeof(line), "%s{device=\"%zu\"} %.17g\n", name,
+                    i + 1, static_cast<double>(value(*m_devices[i])));
+      out += line;
+    }
+  };
+  constexpr auto relaxed = std::memory_order_relaxed;
+
+  perDevice("owon_samples_total", "counter", "Readings taken.",
+            [](const AcquisitionMetrics &m) { return m.samples.load(relaxed); });
+  perDevice("owon_samples_per_second", "gauge",
+            "Readings per second over the last second.",
+            [](const AcquisitionMetrics &m) {
+              return m.samplesPerSecond.load(relaxed);
+            });
+  const std::int64_t now = Reading::now();
+  perDevice("owon_last_reading_age_seconds", "gauge",
+            "Time since the last reading.", [now](const AcquisitionMetrics &m) {
+              const std::int64_t last = m.lastReadingNs.load(relaxed);
+              return last == 0 ? std::numeric_limits<double>::infinity()
+                               : (now - last) / 1e9;
+            });
+  perDevice("owon_connected", "gauge", "1 while the meter is connected.",
+            [](const AcquisitionMetrics &m) {
+              return m.connected.load(relaxed) ? 1 : 0;
+            });
+  perDevice("owon_serial_errors_total", "counter",
+            "Port errors and failed connection attempts.",
+            [](const AcquisitionMetrics &m) {
+              return m.serialErrors.load(relaxed);
+            });
+  perDevice("owon_reconnects_total", "counter",
+            "Successful connections after the first.",
+            [](const AcquisitionMetrics &m) {
+              return m.reconnects.load(relaxed);
+            });
+  perDevice("owon_scpi_timeouts_total", "counter", "Queries without answer.",
+            [](const AcquisitionMetrics &m) { return m.timeouts.load(relaxed); });
+  perDevice("owon_decode_failures_total", "counter",
+            "Responses that could not be parsed.",
+            [](const AcquisitionMetrics &m) {
+              return m.decodeFailures.load(relaxed);
+            });
+  perDevice("owon_scpi_queries_in_flight", "gauge",
+            "Queries sent but not yet answered.",
+            [](const AcquisitionMetrics &m) {
+              return m.queriesInFlight.load(relaxed);
+            });
+
+  emitHeader("owon_query_latency_seconds", "summary",
+             "MEAS1? round trip time.");
+  for (std::size_t i = 0; i < m_devices.size(); ++i) {
+    const AcquisitionMetrics &m = *m_devices[i];
+    const std::pair<const char *, std::uint64_t> quantiles[] = {
+        {"0.5", m.latencyP50Ns.load(relaxed)},
+        {"0.99", m.latencyP99Ns.load(relaxed)},
+        {"0.999", m.latencyP999Ns.load(relaxed)},
+    };
+    for (const auto &[quantile, ns] : quantiles) {
+      std::snprintf(line, sizeof(line),
+                    "owon_query_latency_seconds{device=\"%zu\",quantile=\"%s\"} "
+                    "%.9f\n",
+                    i + 1, quantile, ns / 1e9);
+      out += line;
+    }
+    std::snprintf(line, sizeof(line),
+                  "owon_query_latency_seconds_sum{device=\"%zu\"} %.9f\n",
+                  i + 1, m.latencySumNs.load(relaxed) / 1e9);
+    out += line;
+    std::snprintf(line, sizeof(line),
+                  "owon_query_latency_seconds_count{device=\"%zu\"} %llu\n",
+                  i + 1,
+                  static_cast<unsigned long long>(m.latencyCount.load(relaxed)));
+    out += line;
+  }
+
+  if (!m_rings.empty()) {
+    emitHeader("owon_ring_depth", "gauge", "Readings waiting in a ring.");
+    for (const auto &[name, ring] : m_rings) {
+      std::snprintf(line, sizeof(line), "owon_ring_depth{ring=\"%s\"} %zu\n",
+                    name.toUtf8().constData(), ring->size());
+      out += line;
+    }
+    emitHeader("owon_ring_overruns_total", "counter",
+               "Readings dropped because a consumer fell behind.");
+    for (const auto &[name, ring] : m_rings) {
+      std::snprintf(line, sizeof(line),
+                    "owon_ring_overruns_total{ring=\"%s\"} %llu\n",
+                    name.toUtf8().constData(),
+                    static_cast<unsigned long long>(ring->overruns()));
+      out += line;
+    }
+  }
+  return out;
+}
@@ -0,0 +1,54 @@
+#ifndef METRICSSERVER_H
+#define METRICSSERVER_H
+
+#include <QByteArray>
+#include <QHostAddress>
+#include <QObject>
+#include <QString>
+#include <QTcpServer>
+#include <memory>
+#include <vector>
+
+#include "AcquisitionMetrics.h"
+#include "SampleRing.h"
+
+// Minimal HTTP server answering GET /metrics in the Prometheus text format.
+// It has no timers and reads the workers' atomics only while answering a
+// scrape, so between scrapes it costs nothing, and it never takes a lock
+// the acquisition thread could be waiting on. Meant for localhost.
+class MetricsServer final : public QObject {
+  Q_OBJECT
+
+public:
+  explicit MetricsServer(QObject *parent = nullptr);
+
+  // Register before listen(); device numbers are 1-based in the output
+  void addDevice(std::shared_ptr<const AcquisitionMetrics> metrics);
+
+  // Depth and overruns of a consumer ring, e.g. "display" or "stream"
+  void addRing(const QString &name, std::shared_ptr<const ReadingRing> ring);
+
+  // Prometheus text exposition of everything registered
+  [[nodiscard]] QByteArray render() const;
+
+public slots:
+  void listen(const QHostAddress &address, quint16 port);
+
+signals:
+  void errorOccurred(const QString &message);
+
+private slots:
+  void onNewConnection();
+
+private:
+  struct NamedRing {
+    QString name;
+    std::shared_ptr<const ReadingRing> ring;
+  };
+
+  QTcpServer *m_server = nullptr;
+  std::vector<std::shared_ptr<const AcquisitionMetrics>> m_devices;
+  std::vector<NamedRing> m_rings;
+};
+
+#endif // METRICSSERVER_H
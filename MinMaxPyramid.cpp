@@ -0,0 +1,80 @@
+#include "MinMaxPyramid.h"
+
+#include <algorithm>
+
+MinMaxPyramid::MinMaxPyramid(const std::size_t capacity) {
+  m_capacity = 4;
+  while (m_capacity < capacity) {
+    m_capacity <<= kShift;
+  }
+  m_raw.resize(m_capacity);
+  // The coarsest level keeps four blocks; one block covering the whole ring
+  // could never be used since it is always partly overwritten
+  for (std::size_t buckets = m_capacity >> kShift; buckets >= 4;
+       buckets >>= kShift) {
+    m_levels.emplace_back(buckets);
+  }
+}
+
+void MinMaxPyramid::push(const float value) {
+  const std::uint64_t index = m_total++;
+  m_raw[index & (m_capacity - 1)] = value;
+
+  int shift = kShift;
+  for (auto &level : m_levels) {
+    Bucket &bucket = level[(index >> shift) & (level.size() - 1)];
+    if ((index & ((std::uint64_t{1} << shift) - 1)) == 0) {
+      // First sample of a new block; whatever was here is a whole
+      // capacity old
+      bucket.min = bucket.max = value;
+    } else {
+      bucket.min = std::min(bucket.min, value);
+      bucket.max = std::max(bucket.max, value);
+    }
+    shift += kShift;
+  }
+}
+
+void MinMaxPyramid::clear() { m_total = 0; }
+
+MinMaxPyramid::Range MinMaxPyramid::range(std::uint64_t begin,
+                                          std::uint64_t end) const {
+  Range result{0, 0, false};
+  begin = std::max(begin, first());
+  end = std::min(end, m_total);
+
+  auto add = [&result](const float min, const float max) {
+    if (!result.valid) {
+      result = {min, max, true};
+    } else {
+      result.min = std::min(result.min, min);
+      result.max = std::max(result.max, max);
+    }
+  };
+
+  // Greedy walk: at each position take the largest aligned block that still
+  // fits in what is left of the range
+  while (begin < end) {
+    int level = 0;
+    while (level < static_cast<int>(m_levels.size())) {
+      const int shift = (level + 1) * kShift;
+      const std::uint64_t size = std::uint64_t{1} << shift;
+      if ((begin & (size - 1)) != 0 || begin + size > end) {
+        break;
+      }
+      ++level;
+    }
+    if (level == 0) {
+      const float value = m_raw[begin & (m_capacity - 1)];
+      add(value, value);
+      ++begin;
+    } else {
+      const auto &buckets = m_levels[level - 1];
+      const int shift = level * kShift;
+      const Bucket &bucket = buckets[(begin >> shift) & (buckets.size() - 1)];
+      add(bucket.min, bucket.max);
+      begin += std::uint64_t{1} << shift;
+    }
+  }
+  return result;
+}
@@ -0,0 +1,56 @@
+#ifndef MINMAXPYRAMID_H
+#define MINMAXPYRAMID_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Sample history with min/max summaries kept up to date on every push.
+// Level 0 holds the raw values in a ring; level k holds the min and max of
+// each aligned block of 4^k samples. Any index range can then be summarised
+// by combining a handful of blocks, so drawing millions of points at a few
+// thousand pixels never touches more than O(pixels * levels) entries.
+class MinMaxPyramid {
+public:
+  struct Range {
+    float min;
+    float max;
+    bool valid;
+  };
+
+  // capacity is rounded up to a power of four
+  explicit MinMaxPyramid(std::size_t capacity);
+
+  void push(float value);
+
+  void clear();
+
+  // Total number of samples ever pushed; indices below first() have been
+  // overwritten
+  [[nodiscard]] std::uint64_t total() const { return m_total; }
+
+  [[nodiscard]] std::uint64_t first() const {
+    return m_total > m_capacity ? m_total - m_capacity : 0;
+  }
+
+  [[nodiscard]] std::size_t capacity() const { return m_capacity; }
+
+  // Min and max over [begin, end); begin must be >= first()
+  [[nodiscard]] Range range(std::uint64_t begin, std::uint64_t end) const;
+
+private:
+  static constexpr int kShift = 2; // 4 children per block
+
+  struct Bucket {
+    float min;
+    float max;
+  };
+
+  std::size_t m_capacity;
+  std::vector<float> m_raw;
+  // m_levels[k - 1] holds blocks of 4^k samples
+  std::vector<std::vector<Bucket>> m_levels;
+  std::uint64_t m_total = 0;
+};
+
+#endif // MINMAXPYRAMID_H
@@ -0,0 +1,109 @@
+#include "PortDiscovery.h"
+
+#include "ScpiCommandQueue.h"
+
+#include <QSerialPort>
+#include <algorithm>
+
+PortDiscovery::PortDiscovery(QObject *parent) : QObject(parent) {}
+
+PortDiscovery::~PortDiscovery() { cancel(); }
+
+void PortDiscovery::start(const QList<QSerialPortInfo> &ports,
+                          const int timeoutMs) {
+  cancel();
+  const QList<QSerialPortInfo> candidates =
+      ports.isEmpty() ? QSerialPortInfo::availablePorts() : ports;
+
+  std::vector<Result> failed;
+  for (const QSerialPortInfo &info : candidates) {
+    auto *port = new QSerialPort(info, this);
+    port->setBaudRate(QSerialPort::Baud115200);
+    port->setDataBits(QSerialPort::Data8);
+    port->setParity(QSerialPort::NoParity);
+    port->setStopBits(QSerialPort::OneStop);
+    port->setFlowControl(QSerialPort::NoFlowControl);
+    if (!port->open(QIODevice::ReadWrite)) {
+      Result result;
+      result.portName = info.portName();
+      result.error = port->errorString();
+      failed.push_back(result);
+      delete port;
+      continue;
+    }
+
+    auto *queue = new ScpiCommandQueue(port);
+    queue->attach(port);
+    m_probes.push_back({port, queue});
+    queue->query(
+        "*IDN?",
+        [this, port](const bool ok, const QByteArray &line) {
+          finishProbe(port, ok ? parseIdentity(port->portName(),
+                                               QString::fromLatin1(line))
+                               : Result{port->portName(), false, {}, {}, {},
+                                        {}, "No response"});
+        },
+        timeoutMs);
+  }
+
+  // Report ports that could not even be opened once the caller has had a
+  // chance to connect to our signals
+  QMetaObject::invokeMethod(
+      this,
+      [this, failed] {
+        for (const Result &result : failed) {
+          emit probed(result);
+        }
+        if (m_probes.empty()) {
+          emit finished();
+        }
+      },
+      Qt::QueuedConnection);
+}
+
+void PortDiscovery::cancel() {
+  // Detach first so the failed handlers do not report anything
+  auto probes = std::move(m_probes);
+  m_probes.clear();
+  for (const Probe &probe : probes) {
+    probe.queue->detach();
+    probe.port->close();
+    probe.port->deleteLater();
+  }
+}
+
+PortDiscovery::Result PortDiscovery::parseIdentity(const QString &portName,
+                                                   const QString &line) {
+  Result result;
+  result.portName = portName;
+  const QStringList parts = line.trimmed().split(',');
+  if (parts.size() < 2) {
+    result.error = "Invalid response: " + line.trimmed().left(50);
+    return result;
+  }
+  result.ok = true;
+  result.manufacturer = parts.value(0).trimmed();
+  result.model = parts.value(1).trimmed();
+  result.serial = parts.value(2).trimmed();
+  result.firmware = parts.value(3).trimmed();
+  return result;
+}
+
+void PortDiscovery::finishProbe(QSerialPort *port, const Result &result) {
+  const auto it =
+      std::find_if(m_probes.begin(), m_probes.end(),
+                   [port](const Probe &probe) { return probe.port == port; });
+  if (it == m_probes.end()) {
+    return; // cancelled
+  }
+  m_probes.erase(it);
+  // We are inside the port's readyRead or the queue's timer, so let the
+  // event loop delete them
+  port->close();
+  port->deleteLater();
+
+  emit probed(result);
+  if (m_probes.empty()) {
+    emit finished();
+  }
+}
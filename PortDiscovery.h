@@ -0,0 +1,73 @@
+#ifndef PORTDISCOVERY_H
+#define PORTDISCOVERY_H
+
+#include <QList>
+#include <QObject>
+#include <QSerialPortInfo>
+#include <QString>
+#include <vector>
+
+class QSerialPort;
+class ScpiCommandQueue;
+
+// Finds meters by sending *IDN? to every candidate port at once. Each port
+// gets its own short deadline and none waits for another, so a hub full of
+// adapters takes about as long as the slowest single probe. Nothing blocks;
+// results arrive through probed() as they come in.
+class PortDiscovery final : public QObject {
+  Q_OBJECT
+
+public:
+  static constexpr int kProbeTimeoutMs = 500;
+
+  struct Result {
+    QString portName;
+    bool ok = false;
+    QString manufacturer;
+    QString model;
+    QString serial;
+    QString firmware;
+    QString error;
+
+    [[nodiscard]] bool isOwon() const {
+      return ok && (manufacturer.contains("OWON", Qt::CaseInsensitive) ||
+                    model.startsWith("XDM", Qt::CaseInsensitive));
+    }
+  };
+
+  explicit PortDiscovery(QObject *parent = nullptr);
+
+  ~PortDiscovery() override;
+
+  // Probes the given ports, or every port on the system if none are given.
+  // Cancels a discovery still in progress.
+  void start(const QList<QSerialPortInfo> &ports = {},
+             int timeoutMs = kProbeTimeoutMs);
+
+  // Closes all ports; no more signals are emitted for this round
+  void cancel();
+
+  [[nodiscard]] bool running() const { return !m_probes.empty(); }
+
+  // Splits an *IDN? response ("OWON,XDM1041,2206...,V3.3.0,...")
+  static Result parseIdentity(const QString &portName, const QString &line);
+
+signals:
+  void probed(const PortDiscovery::Result &result);
+
+  void finished();
+
+private:
+  struct Probe {
+    QSerialPort *port;
+    ScpiCommandQueue *queue;
+  };
+
+  std::vector<Probe> m_probes;
+
+  void finishProbe(QSerialPort *port, const Result &result);
+};
+
+Q_DECLARE_METATYPE(PortDiscovery::Result)
+
+#endif // PORTDISCOVERY_H
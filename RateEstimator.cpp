@@ -0,0 +1,59 @@
+#include "RateEstimator.h"
+
+#include <algorithm>
+
+void RateEstimator::reset(const std::int64_t seedPeriodNs) {
+  m_count = 0;
+  m_probe_start_ns = 0;
+  m_last_change_ns = 0;
+  m_has_value = false;
+  m_has_estimate = false;
+  m_seed_period_ns = seedPeriodNs;
+  m_period_ns = seedPeriodNs;
+}
+
+void RateEstimator::addSample(const std::int64_t sentNs,
+                              const std::int64_t receivedNs,
+                              const double value) {
+  const std::int64_t rtt = receivedNs - sentNs;
+  m_rtt_ns = m_rtt_ns == 0 ? rtt : (m_rtt_ns * 7 + rtt) / 8;
+
+  if (m_has_estimate) {
+    return;
+  }
+  if (m_probe_start_ns == 0) {
+    m_probe_start_ns = receivedNs;
+  }
+
+  // The meter sampled somewhere between our query going out and the
+  // response coming back; the midpoint is the best guess.
+  const std::int64_t sampledNs = sentNs + rtt / 2;
+  if (!m_has_value) {
+    m_has_value = true;
+    m_last_value = value;
+    m_last_change_ns = sampledNs;
+  } else if (value != m_last_value) {
+    m_last_value = value;
+    if (m_count < kIntervals) {
+      m_intervals[m_count++] = sampledNs - m_last_change_ns;
+    }
+    m_last_change_ns = sampledNs;
+  }
+
+  if (m_count == kIntervals || receivedNs - m_probe_start_ns >= kProbeNs) {
+    finishProbe();
+  }
+}
+
+void RateEstimator::finishProbe() {
+  m_has_estimate = true;
+  if (m_count < 4) {
+    // Input too stable to tell; stay with the nominal rate
+    m_period_ns = m_seed_period_ns;
+    return;
+  }
+  const auto quartile = m_intervals.begin() + m_count / 4;
+  std::nth_element(m_intervals.begin(), quartile,
+                   m_intervals.begin() + m_count);
+  m_period_ns = *quartile;
+}
@@ -0,0 +1,45 @@
+#ifndef RATEESTIMATOR_H
+#define RATEESTIMATOR_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Works out how often the meter actually produces a new value. While probing,
+// the worker polls back to back; every time the value changes the interval
+// since the previous change is recorded. Identical consecutive values are
+// common on a stable input, so some intervals are multiples of the real
+// update period - the estimate is therefore taken from the low end of the
+// distribution rather than the mean.
+class RateEstimator {
+public:
+  static constexpr std::size_t kIntervals = 32;
+  static constexpr std::int64_t kProbeNs = 3'000'000'000;
+
+  void reset(std::int64_t seedPeriodNs);
+
+  void addSample(std::int64_t sentNs, std::int64_t receivedNs, double value);
+
+  [[nodiscard]] bool probing() const { return !m_has_estimate; }
+
+  [[nodiscard]] std::int64_t updatePeriodNs() const { return m_period_ns; }
+
+  // Exponential average of query-to-response time
+  [[nodiscard]] std::int64_t roundTripNs() const { return m_rtt_ns; }
+
+private:
+  std::array<std::int64_t, kIntervals> m_intervals{};
+  std::size_t m_count = 0;
+  std::int64_t m_probe_start_ns = 0;
+  std::int64_t m_last_change_ns = 0;
+  double m_last_value = 0.0;
+  bool m_has_value = false;
+  bool m_has_estimate = false;
+  std::int64_t m_period_ns = 0;
+  std::int64_t m_seed_period_ns = 0;
+  std::int64_t m_rtt_ns = 0;
+
+  void finishProbe();
+};
+
+#endif // RATEESTIMATOR_H
@@ -0,0 +1,87 @@
+#ifndef READING_H
+#define READING_H
+
+#include <chrono>
+#include <cstdint>
+
+enum class MeasurementMode : std::uint8_t {
+  Unknown,
+  VoltageDC,
+  VoltageAC,
+  CurrentDC,
+  CurrentAC,
+  Resistance,
+  Continuity,
+  Diode,
+  Capacitance,
+  Frequency,
+  Period,
+  Temperature,
+};
+
+enum class Unit : std::uint8_t {
+  None,
+  Volt,
+  Ampere,
+  Ohm,
+  Farad,
+  Hertz,
+  Second,
+  Celsius,
+  Fahrenheit,
+  Kelvin,
+};
+
+// One sample as delivered by the meter, in base SI units (e.g. 0.0123 V, not
+// 12.3 mV). Formatting for display is done separately, see ReadingFormat.h.
+struct Reading {
+  double value = 0.0;
+  Unit unit = Unit::None;
+  MeasurementMode mode = MeasurementMode::Unknown;
+  bool overload = false;
+  // Index of the meter within its InstrumentPool, 0 with a single meter
+  std::uint8_t device = 0;
+  // Secondary display (MEAS2), when the meter has one switched on
+  bool hasSecondary = false;
+  Unit secondaryUnit = Unit::None;
+  bool secondaryOverload = false;
+  // First reading after an interruption such as a reconnect
+  bool gap = false;
+  // steady_clock nanoseconds; only differences between readings are meaningful
+  std::int64_t timestampNs = 0;
+  double secondary = 0.0;
+
+  static std::int64_t now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+  }
+};
+
+constexpr Unit unitForMode(const MeasurementMode mode) {
+  switch (mode) {
+  case MeasurementMode::VoltageDC:
+  case MeasurementMode::VoltageAC:
+  case MeasurementMode::Diode:
+    return Unit::Volt;
+  case MeasurementMode::CurrentDC:
+  case MeasurementMode::CurrentAC:
+    return Unit::Ampere;
+  case MeasurementMode::Resistance:
+  case MeasurementMode::Continuity:
+    return Unit::Ohm;
+  case MeasurementMode::Capacitance:
+    return Unit::Farad;
+  case MeasurementMode::Frequency:
+    return Unit::Hertz;
+  case MeasurementMode::Period:
+    return Unit::Second;
+  case MeasurementMode::Temperature:
+    return Unit::Celsius;
+  case MeasurementMode::Unknown:
+    break;
+  }
+  return Unit::None;
+}
+
+#endif // READING_H
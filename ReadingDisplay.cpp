@@ -0,0 +1,114 @@
+#include "ReadingDisplay.h"
+
+#include <QMouseEvent>
+#include <QPainter>
+#include <QPaintEvent>
+#include <algorithm>
+
+ReadingDisplay::ReadingDisplay(QWidget *parent) : QFrame(parent) {}
+
+void ReadingDisplay::setText(const QString &text) {
+  if (text == m_text) {
+    return;
+  }
+  validateCache();
+  // Characters are right-aligned, so compare from the right and repaint only
+  // the cells that differ
+  const qsizetype oldLength = m_text.size();
+  const qsizetype newLength = text.size();
+  QRect dirty;
+  for (qsizetype k = 0; k < std::max(oldLength, newLength); ++k) {
+    const QChar before = k < oldLength ? m_text[oldLength - 1 - k] : QChar();
+    const QChar after = k < newLength ? text[newLength - 1 - k] : QChar();
+    if (before != after) {
+      dirty |= cellRect(std::max(oldLength, newLength) - 1 - k,
+                        std::max(oldLength, newLength));
+    }
+  }
+  m_text = text;
+  if (!dirty.isEmpty()) {
+    update(dirty);
+  }
+}
+
+QSize ReadingDisplay::sizeHint() const {
+  const QFontMetrics metrics = fontMetrics();
+  return {metrics.horizontalAdvance('0') * 10 + 2 * frameWidth(),
+          metrics.height() + 2 * frameWidth()};
+}
+
+void ReadingDisplay::changeEvent(QEvent *event) {
+  if (event->type() == QEvent::FontChange ||
+      event->type() == QEvent::PaletteChange ||
+      event->type() == QEvent::StyleChange) {
+    m_glyphs.clear();
+    update();
+  }
+  QFrame::changeEvent(event);
+}
+
+void ReadingDisplay::mouseReleaseEvent(QMouseEvent *event) {
+  if (event->button() == Qt::LeftButton) {
+    emit clicked();
+    return;
+  }
+  QFrame::mouseReleaseEvent(event);
+}
+
+void ReadingDisplay::validateCache() {
+  const QFontMetrics metrics = fontMetrics();
+  const int cellWidth = metrics.horizontalAdvance('0');
+  const int cellHeight = metrics.height();
+  const qreal ratio = devicePixelRatioF();
+  if (cellWidth != m_cell_width || cellHeight != m_cell_height ||
+      ratio != m_glyph_ratio) {
+    // Moved to a screen with another scale, or the font was resized
+    m_glyphs.clear();
+    m_cell_width = cellWidth;
+    m_cell_height = cellHeight;
+    m_glyph_ratio = ratio;
+  }
+}
+
+const QPixmap &ReadingDisplay::glyph(const QChar c) {
+  auto it = m_glyphs.find(c);
+  if (it != m_glyphs.end()) {
+    return *it;
+  }
+  QPixmap pixmap(QSize(m_cell_width, m_cell_height) * m_glyph_ratio);
+  pixmap.setDevicePixelRatio(m_glyph_ratio);
+  pixmap.fill(Qt::transparent);
+  QPainter painter(&pixmap);
+  painter.setFont(font());
+  painter.setPen(palette().windowText().color());
+  painter.drawText(QRect(0, 0, m_cell_width, m_cell_height), Qt::AlignCenter,
+                   QString(c));
+  painter.end();
+  return *m_glyphs.insert(c, pixmap);
+}
+
+QRect ReadingDisplay::cellRect(const qsizetype index,
+                               const qsizetype length) const {
+  const QRect area = contentsRect();
+  const int right = area.right() + 1;
+  const int top = area.top() + (area.height() - m_cell_height) / 2;
+  const int x = right - static_cast<int>(length - index) * m_cell_width;
+  return {x, top, m_cell_width, m_cell_height};
+}
+
+void ReadingDisplay::paintEvent(QPaintEvent *event) {
+  QFrame::paintEvent(event);
+  validateCache();
+  QPainter painter(this);
+  painter.setClipRect(contentsRect());
+  const qsizetype length = m_text.size();
+  for (qsizetype i = 0; i < length; ++i) {
+    const QRect cell = cellRect(i, length);
+    if (!cell.intersects(event->rect())) {
+      continue;
+    }
+    if (m_text[i] != ' ') {
+      painter.drawPixmap(cell.topLeft(), glyph(m_text[i]));
+    }
+  }
+}
@@ -0,0 +1,51 @@
+#ifndef READINGDISPLAY_H
+#define READINGDISPLAY_H
+
+#include <QFrame>
+#include <QHash>
+#include <QPixmap>
+#include <QString>
+
+// The big right-aligned reading. Each character is rendered once per font,
+// colour and screen scale into a cached pixmap; after that a new value costs
+// a string compare and a few pixmap blits for the characters that actually
+// changed. Setting the same text again does nothing at all.
+class ReadingDisplay final : public QFrame {
+  Q_OBJECT
+
+public:
+  explicit ReadingDisplay(QWidget *parent = nullptr);
+
+  void setText(const QString &text);
+
+  [[nodiscard]] QString text() const { return m_text; }
+
+  [[nodiscard]] QSize sizeHint() const override;
+
+signals:
+  void clicked();
+
+protected:
+  void paintEvent(QPaintEvent *event) override;
+
+  void changeEvent(QEvent *event) override;
+
+  void mouseReleaseEvent(QMouseEvent *event) override;
+
+private:
+  QString m_text;
+  QHash<QChar, QPixmap> m_glyphs;
+  int m_cell_width = 0;
+  int m_cell_height = 0;
+  qreal m_glyph_ratio = 0;
+
+  // Throws away the glyph cache if the font, palette or scale changed
+  void validateCache();
+
+  const QPixmap &glyph(QChar c);
+
+  // Cell for the character at position index of a text of length length
+  [[nodiscard]] QRect cellRect(qsizetype index, qsizetype length) const;
+};
+
+#endif // READINGDISPLAY_H
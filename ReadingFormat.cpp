@@ -0,0 +1,65 @@
+#include "ReadingFormat.h"
+
+#include <cmath>
+
+QString unitSymbol(const Unit unit) {
+  switch (unit) {
+  case Unit::Volt:
+    return "V";
+  case Unit::Ampere:
+    return "A";
+  case Unit::Ohm:
+    return "Ω";
+  case Unit::Farad:
+    return "F";
+  case Unit::Hertz:
+    return "Hz";
+  case Unit::Second:
+    return "s";
+  case Unit::Celsius:
+    return "°C";
+  case Unit::Fahrenheit:
+    return "°F";
+  case Unit::Kelvin:
+    return "K";
+  case Unit::None:
+    break;
+  }
+  return {};
+}
+
+QString formatReading(const Reading &reading) {
+  if (reading.overload) {
+    return "OL";
+  }
+
+  const QString symbol = unitSymbol(reading.unit);
+  double value = reading.value;
+
+  // Temperatures are shown as-is; "m°C" would just be confusing
+  const bool scalable = reading.unit != Unit::None &&
+                        reading.unit != Unit::Celsius &&
+                        reading.unit != Unit::Fahrenheit &&
+                        reading.unit != Unit::Kelvin;
+
+  QString prefix;
+  if (scalable && value != 0.0) {
+    static const char *const prefixes[] = {"p", "n", "µ", "m", "",
+                                           "k", "M", "G"};
+    constexpr int unity = 4;
+    int exponent = static_cast<int>(std::floor(std::log10(std::fabs(value)) / 3));
+    exponent = qBound(-unity, exponent, 3);
+    value /= std::pow(1000.0, exponent);
+    prefix = QString::fromUtf8(prefixes[unity + exponent]);
+  }
+
+  // Keep 5 significant digits: 1.2345, 12.345, 123.45
+  const double magnitude = std::fabs(value);
+  const int decimals = magnitude < 10 ? 4 : magnitude < 100 ? 3 : 2;
+
+  QString text = QString::number(value, 'f', decimals);
+  if (!symbol.isEmpty()) {
+    text += ' ' + prefix + symbol;
+  }
+  return text;
+}
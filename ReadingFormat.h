@@ -0,0 +1,16 @@
+#ifndef READINGFORMAT_H
+#define READINGFORMAT_H
+
+#include <QString>
+
+#include "Reading.h"
+
+// Presentation helpers; nothing on the acquisition path calls these.
+
+QString unitSymbol(Unit unit);
+
+// "12.345 mV", "OL", ... with 5 significant digits to match the meter's
+// 4 1/2 digit display
+QString formatReading(const Reading &reading);
+
+#endif // READINGFORMAT_H
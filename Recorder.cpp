@@ -0,0 +1,178 @@
+#include "Recorder.h"
+
+#include <QDebug>
+#include <iostream>
+
+Recorder::Recorder(QObject *parent)
+    : QObject(parent), m_ring(std::make_shared<ReadingRing>(kRingCapacity)),
+      m_readings(kBatchRecords), m_batch(kBatchRecords) {}
+
+Recorder::~Recorder() { stop(); }
+
+void Recorder::start(const QString &path, const RecordingHeader &header) {
+  stop();
+
+  m_file = new QFile(path, this);
+  // Unbuffered: each batch goes out in a single write() of our own buffer
+  if (!m_file->open(QIODevice::WriteOnly | QIODevice::Truncate |
+                    QIODevice::Unbuffered)) {
+    const QString message =
+        "Could not create " + path + ": " + m_file->errorString();
+    delete m_file;
+    m_file = nullptr;
+    emit errorOccurred(message);
+    return;
+  }
+  if (m_file->write(reinterpret_cast<const char *>(&header), sizeof(header)) !=
+      sizeof(header)) {
+    const QString message = "Could not write " + path;
+    delete m_file;
+    m_file = nullptr;
+    emit errorOccurred(message);
+    return;
+  }
+
+  m_start_ns = header.startTimestampNs;
+  m_records = 0;
+  m_overruns = m_ring->overruns();
+  m_gap_pending = false;
+  if (m_trigger) {
+    m_trigger->reset();
+  }
+
+  if (!m_timer) {
+    m_timer = new QTimer(this);
+    m_timer->setInterval(kDrainIntervalMs);
+    connect(m_timer, &QTimer::timeout, this, &Recorder::drain);
+  }
+  m_timer->start();
+  std::cerr << "Recording to " << path.toStdString() << std::endl;
+  emit started(path);
+}
+
+void Recorder::stop() {
+  if (!m_file) {
+    return;
+  }
+  m_timer->stop();
+  drain();
+  const QString path = m_file->fileName();
+  m_file->close();
+  delete m_file;
+  m_file = nullptr;
+  std::cerr << "Recording stopped, " << m_records << " records";
+  if (m_trigger) {
+    std::cerr << " from " << m_trigger->triggers() << " triggers";
+  }
+  std::cerr << std::endl;
+  emit stopped(path, m_records);
+}
+
+void Recorder::drain() {
+  if (!m_file) {
+    return;
+  }
+  std::size_t count;
+  while ((count = m_ring->popBulk(m_readings.data(), m_readings.size())) > 0) {
+    // A ring overrun means samples are missing before this batch
+    const std::uint64_t overruns = m_ring->overruns();
+    const bool gap = overruns != m_overruns;
+    m_overruns = overruns;
+    m_gap_pending = m_gap_pending || gap;
+
+    if (m_trigger) {
+      if (!writeTriggered(count)) {
+        return;
+      }
+      continue;
+    }
+
+    std::size_t records = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+      const Reading &reading = m_readings[i];
+      if (reading.timestampNs < m_start_ns) {
+        continue; // left over from before this recording started
+      }
+      fill(m_batch[records++], reading, 0);
+    }
+    if (records == 0) {
+      continue;
+    }
+    if (m_gap_pending) {
+      m_batch[0].flags |= RecordingRecord::Gap;
+      m_gap_pending = false;
+    }
+    if (!writeBatch(records)) {
+      return;
+    }
+  }
+}
+
+bool Recorder::writeTriggered(const std::size_t count) {
+  std::size_t records = 0;
+  bool ok = true;
+  const auto save = [this, &records, &ok](const Reading &reading,
+                                          std::uint16_t flags) {
+    if (!ok) {
+      return;
+    }
+    if (m_gap_pending) {
+      flags |= RecordingRecord::Gap;
+      m_gap_pending = false;
+    }
+    fill(m_batch[records++], reading, flags);
+    if (flags & RecordingRecord::Trigger) {
+      emit triggered(reading.timestampNs);
+    }
+    // A capture can be longer than the batch buffer
+    if (records == m_batch.size()) {
+      ok = writeBatch(records);
+      records = 0;
+    }
+  };
+  for (std::size_t i = 0; i < count && ok; ++i) {
+    if (m_readings[i].timestampNs >= m_start_ns) {
+      // Outages are marked on whatever gets written next
+      m_gap_pending = m_gap_pending || m_readings[i].gap;
+      m_trigger->feed(m_readings[i], save);
+    }
+  }
+  return ok && (records == 0 || writeBatch(records));
+}
+
+void Recorder::fill(RecordingRecord &record, const Reading &reading,
+                    const std::uint16_t flags) const {
+  record.offsetNs = reading.timestampNs - m_start_ns;
+  record.value = reading.value;
+  record.mode = static_cast<std::uint8_t>(reading.mode);
+  record.unit = static_cast<std::uint8_t>(reading.unit);
+  record.flags = flags | (reading.overload ? RecordingRecord::Overload : 0) |
+                 (reading.gap ? RecordingRecord::Gap : 0);
+  record.device = reading.device + 1u;
+}
+
+void Recorder::setTrigger(const TriggerEngine::Condition &condition,
+                          const std::size_t preSamples,
+                          const std::size_t postSamples) {
+  m_trigger =
+      std::make_unique<TriggerEngine>(condition, preSamples, postSamples);
+}
+
+void Recorder::clearTrigger() { m_trigger.reset(); }
+
+bool Recorder::writeBatch(const std::size_t count) {
+  const qint64 bytes = static_cast<qint64>(count * sizeof(RecordingRecord));
+  if (m_file->write(reinterpret_cast<const char *>(m_batch.data()), bytes) !=
+      bytes) {
+    const QString message = "Recording write failed: " + m_file->errorString();
+    qDebug() << message;
+    m_timer->stop();
+    m_file->close();
+    delete m_file;
+    m_file = nullptr;
+    emit errorOccurred(message);
+    return false;
+  }
+  m_records += count;
+  return true;
+}
@@ -0,0 +1,82 @@
+#ifndef RECORDER_H
+#define RECORDER_H
+
+#include <QFile>
+#include <QObject>
+#include <QString>
+#include <QTimer>
+#include <memory>
+#include <vector>
+
+#include "RecordingFormat.h"
+#include "SampleRing.h"
+#include "TriggerEngine.h"
+
+// Streams every reading to an append-only recording file. Lives in its own
+// thread and drains its ring in batches, so disk latency never reaches the
+// acquisition loop. Memory use is fixed: one ring, one batch buffer.
+//
+// With a trigger set, only the samples around each trigger event are
+// written; the rest are checked and dropped on this thread.
+class Recorder final : public QObject {
+  Q_OBJECT
+
+public:
+  static constexpr std::size_t kRingCapacity = 65536;
+  static constexpr std::size_t kBatchRecords = 4096;
+  static constexpr int kDrainIntervalMs = 250;
+
+  explicit Recorder(QObject *parent = nullptr);
+
+  ~Recorder() override;
+
+  // Attach this to the acquisition worker while recording
+  [[nodiscard]] std::shared_ptr<ReadingRing> ring() const { return m_ring; }
+
+  // Takes effect at the next start()
+  void setTrigger(const TriggerEngine::Condition &condition,
+                  std::size_t preSamples, std::size_t postSamples);
+
+  void clearTrigger();
+
+public slots:
+  void start(const QString &path, const RecordingHeader &header);
+
+  void stop();
+
+signals:
+  void started(const QString &path);
+
+  void stopped(const QString &path, quint64 records);
+
+  // A trigger fired on the sample taken at timestampNs
+  void triggered(qint64 timestampNs);
+
+  void errorOccurred(const QString &message);
+
+private slots:
+  void drain();
+
+private:
+  std::shared_ptr<ReadingRing> m_ring;
+  std::vector<Reading> m_readings;
+  std::vector<RecordingRecord> m_batch;
+  QFile *m_file = nullptr;
+  QTimer *m_timer = nullptr;
+  std::int64_t m_start_ns = 0;
+  quint64 m_records = 0;
+  std::uint64_t m_overruns = 0;
+  std::unique_ptr<TriggerEngine> m_trigger;
+  // Samples went missing since the last record written
+  bool m_gap_pending = false;
+
+  bool writeBatch(std::size_t count);
+
+  // Runs a batch through the trigger and writes what it keeps
+  bool writeTriggered(std::size_t count);
+
+  void fill(RecordingRecord &record, const Reading &reading,
+            std::uint16_t flags) const;
+};
+
+#endif // RECORDER_H
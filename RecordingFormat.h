@@ -0,0 +1,66 @@
+#ifndef RECORDINGFORMAT_H
+#define RECORDINGFORMAT_H
+
+#include <cstdint>
+#include <cstring>
+
+#include "Reading.h"
+
+// On-disk layout of a recording (*.owr): one RecordingHeader followed by
+// RecordingRecords until end of file. All fields are little-endian, which is
+// what every platform we build for uses natively. The file is append-only;
+// a recording cut short by a crash is still readable up to the last whole
+// record. RecordingRecord::device used to be reserved and always 0; version 1
+// readers must treat 0 there as "meter not recorded".
+
+struct RecordingRecord {
+  enum Flags : std::uint16_t {
+    Overload = 1 << 0,
+    // First sample after an interruption (reconnect, dropped samples)
+    Gap = 1 << 1,
+    // The sample a trigger fired on, see TriggerEngine
+    Trigger = 1 << 2,
+  };
+
+  std::int64_t offsetNs; // since RecordingHeader::startTimestampNs
+  double value;
+  std::uint8_t mode;
+  std::uint8_t unit;
+  std::uint16_t flags;
+  // Which meter the sample came from, numbered from 1 like the "device"
+  // column of the CSV output (Reading::device + 1). 0 means not recorded:
+  // files written before this field existed hold 0 here.
+  std::uint32_t device;
+};
+
+struct RecordingHeader {
+  static constexpr char kMagic[8] = {'O', 'W', 'O', 'N', 'R', 'E', 'C', 0};
+  static constexpr std::uint32_t kVersion = 1;
+
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t headerSize;
+  std::uint32_t recordSize;
+  std::uint8_t mode;  // MeasurementMode at start
+  std::uint8_t rate;  // Settings::Rate
+  std::uint8_t reserved0[2];
+  std::int64_t startTimestampNs; // steady clock, see Reading::timestampNs
+  std::int64_t startEpochMs;     // wall clock at the same instant
+  char identity[128];            // *IDN? response, NUL padded
+  char range[16];                // range argument of the CONF command
+  char reserved1[72];
+
+  static RecordingHeader make() {
+    RecordingHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.headerSize = sizeof(RecordingHeader);
+    header.recordSize = sizeof(RecordingRecord);
+    return header;
+  }
+};
+
+static_assert(sizeof(RecordingHeader) == 256, "header layout changed");
+static_assert(sizeof(RecordingRecord) == 24, "record layout changed");
+
+#endif // RECORDINGFORMAT_H
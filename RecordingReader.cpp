@@ -0,0 +1,68 @@
+#include "RecordingReader.h"
+
+#include <algorithm>
+
+RecordingReader::~RecordingReader() { close(); }
+
+bool RecordingReader::open(const QString &path) {
+  close();
+
+  m_file.setFileName(path);
+  if (!m_file.open(QIODevice::ReadOnly)) {
+    m_error = m_file.errorString();
+    return false;
+  }
+  const qint64 size = m_file.size();
+  if (size < static_cast<qint64>(sizeof(RecordingHeader))) {
+    m_error = "File too short for a recording header";
+    m_file.close();
+    return false;
+  }
+  m_map = m_file.map(0, size);
+  if (!m_map) {
+    m_error = "Could not map file: " + m_file.errorString();
+    m_file.close();
+    return false;
+  }
+
+  const auto header = reinterpret_cast<const RecordingHeader *>(m_map);
+  if (std::memcmp(header->magic, RecordingHeader::kMagic,
+                  sizeof(RecordingHeader::kMagic)) != 0 ||
+      header->version != RecordingHeader::kVersion ||
+      header->recordSize != sizeof(RecordingRecord) ||
+      header->headerSize < sizeof(RecordingHeader) ||
+      header->headerSize > size) {
+    m_error = "Not a recording or unsupported version";
+    close();
+    return false;
+  }
+
+  m_header = header;
+  m_records =
+      reinterpret_cast<const RecordingRecord *>(m_map + header->headerSize);
+  // A trailing partial record (recording interrupted mid-write) is ignored
+  m_count = (size - header->headerSize) / sizeof(RecordingRecord);
+  return true;
+}
+
+void RecordingReader::close() {
+  if (m_map) {
+    m_file.unmap(m_map);
+    m_map = nullptr;
+  }
+  if (m_file.isOpen()) {
+    m_file.close();
+  }
+  m_header = nullptr;
+  m_records = nullptr;
+  m_count = 0;
+}
+
+std::size_t RecordingReader::lowerBound(const std::int64_t offsetNs) const {
+  const auto it = std::lower_bound(
+      begin(), end(), offsetNs,
+      [](const RecordingRecord &record, const std::int64_t offset) {
+        return record.offsetNs < offset;
+      });
+  return static_cast<std::size_t>(it - begin());
+}
@@ -0,0 +1,54 @@
+#ifndef RECORDINGREADER_H
+#define RECORDINGREADER_H
+
+#include <QFile>
+#include <QString>
+#include <cstddef>
+
+#include "RecordingFormat.h"
+
+// Random access to a recording through a read-only memory mapping. Nothing is
+// copied into memory up front; pages are faulted in as records are touched.
+class RecordingReader {
+public:
+  RecordingReader() = default;
+
+  ~RecordingReader();
+
+  RecordingReader(const RecordingReader &) = delete;
+  RecordingReader &operator=(const RecordingReader &) = delete;
+
+  bool open(const QString &path);
+
+  void close();
+
+  [[nodiscard]] QString errorString() const { return m_error; }
+
+  [[nodiscard]] const RecordingHeader &header() const { return *m_header; }
+
+  [[nodiscard]] std::size_t count() const { return m_count; }
+
+  [[nodiscard]] const RecordingRecord &record(const std::size_t index) const {
+    return m_records[index];
+  }
+
+  [[nodiscard]] const RecordingRecord *begin() const { return m_records; }
+
+  [[nodiscard]] const RecordingRecord *end() const {
+    return m_records + m_count;
+  }
+
+  // Index of the first record at or after offsetNs (records are in time
+  // order, so this is a binary search)
+  [[nodiscard]] std::size_t lowerBound(std::int64_t offsetNs) const;
+
+private:
+  QFile m_file;
+  uchar *m_map = nullptr;
+  const RecordingHeader *m_header = nullptr;
+  const RecordingRecord *m_records = nullptr;
+  std::size_t m_count = 0;
+  QString m_error;
+};
+
+#endif // RECORDINGREADER_H
@@ -0,0 +1,104 @@
+#include "RunningStats.h"
+
+#include <algorithm>
+#include <cmath>
+
+RunningStats::RunningStats(const std::size_t window)
+    : m_window(window), m_values(window),
+      // One spare slot so a full queue is distinguishable from an empty one
+      m_min_queue(window + 1), m_max_queue(window + 1) {}
+
+void RunningStats::add(const double value) {
+  ++m_count;
+  const double delta = value - m_mean;
+  m_mean += delta / static_cast<double>(m_count);
+  m_m2 += delta * (value - m_mean);
+  if (m_count == 1) {
+    m_min = m_max = value;
+  } else {
+    m_min = std::min(m_min, value);
+    m_max = std::max(m_max, value);
+  }
+
+  if (m_window > 0) {
+    addToWindow(value);
+  }
+}
+
+void RunningStats::addToWindow(const double value) {
+  const std::uint64_t index = m_added++;
+  const std::size_t capacity = m_min_queue.size();
+
+  if (index >= m_window) {
+    // Retire the sample falling out of the window (reverse Welford step)
+    if (m_window == 1) {
+      m_window_mean = m_window_m2 = 0.0;
+    } else {
+      const double old = valueAt(index - m_window);
+      const double n = static_cast<double>(m_window - 1);
+      const double delta = old - m_window_mean;
+      m_window_mean -= delta / n;
+      m_window_m2 -= delta * (old - m_window_mean);
+    }
+
+    const std::uint64_t expired = index - m_window;
+    if (m_min_head != m_min_tail && m_min_queue[m_min_head] == expired) {
+      m_min_head = (m_min_head + 1) % capacity;
+    }
+    if (m_max_head != m_max_tail && m_max_queue[m_max_head] == expired) {
+      m_max_head = (m_max_head + 1) % capacity;
+    }
+  }
+
+  m_values[index % m_window] = value;
+  const double n = static_cast<double>(std::min<std::uint64_t>(m_added, m_window));
+  const double delta = value - m_window_mean;
+  m_window_mean += delta / n;
+  m_window_m2 += delta * (value - m_window_mean);
+
+  // Drop queued candidates the new value makes irrelevant
+  while (m_min_head != m_min_tail &&
+         valueAt(m_min_queue[(m_min_tail + capacity - 1) % capacity]) >= value) {
+    m_min_tail = (m_min_tail + capacity - 1) % capacity;
+  }
+  m_min_queue[m_min_tail] = index;
+  m_min_tail = (m_min_tail + 1) % capacity;
+
+  while (m_max_head != m_max_tail &&
+         valueAt(m_max_queue[(m_max_tail + capacity - 1) % capacity]) <= value) {
+    m_max_tail = (m_max_tail + capacity - 1) % capacity;
+  }
+  m_max_queue[m_max_tail] = index;
+  m_max_tail = (m_max_tail + 1) % capacity;
+}
+
+void RunningStats::reset() {
+  m_count = 0;
+  m_mean = m_m2 = m_min = m_max = 0.0;
+  m_added = 0;
+  m_window_mean = m_window_m2 = 0.0;
+  m_min_head = m_min_tail = m_max_head = m_max_tail = 0;
+}
+
+RunningStats::Snapshot RunningStats::snapshot() const {
+  Snapshot snapshot;
+  snapshot.session.count = m_count;
+  snapshot.session.min = m_min;
+  snapshot.session.max = m_max;
+  snapshot.session.mean = m_mean;
+  snapshot.session.stddev =
+      m_count > 1 ? std::sqrt(m_m2 / static_cast<double>(m_count - 1)) : 0.0;
+
+  if (m_window > 0 && m_added > 0) {
+    const std::uint64_t n = std::min<std::uint64_t>(m_added, m_window);
+    snapshot.window.count = n;
+    snapshot.window.min = valueAt(m_min_queue[m_min_head]);
+    snapshot.window.max = valueAt(m_max_queue[m_max_head]);
+    snapshot.window.mean = m_window_mean;
+    // Rounding can push the retired-sample updates slightly negative
+    snapshot.window.stddev =
+        n > 1 ? std::sqrt(std::max(0.0, m_window_m2) / static_cast<double>(n - 1))
+              : 0.0;
+  }
+  return snapshot;
+}
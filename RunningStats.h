@@ -0,0 +1,65 @@
+#ifndef RUNNINGSTATS_H
+#define RUNNINGSTATS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// O(1)-per-sample statistics. Whole-session figures use Welford's update;
+// the optional sliding window keeps its own Welford state, adding the new
+// sample and retiring the oldest one, and tracks min/max with monotonic
+// queues. Nothing ever re-scans the history.
+class RunningStats {
+public:
+  struct Summary {
+    std::uint64_t count = 0;
+    double min = 0.0;
+    double max = 0.0;
+    double mean = 0.0;
+    double stddev = 0.0; // sample standard deviation (n - 1)
+  };
+
+  struct Snapshot {
+    Summary session;
+    Summary window;
+  };
+
+  // window == 0 disables the sliding statistics
+  explicit RunningStats(std::size_t window = 0);
+
+  void add(double value);
+
+  void reset();
+
+  [[nodiscard]] Snapshot snapshot() const;
+
+  [[nodiscard]] std::size_t window() const { return m_window; }
+
+private:
+  // Session
+  std::uint64_t m_count = 0;
+  double m_mean = 0.0;
+  double m_m2 = 0.0;
+  double m_min = 0.0;
+  double m_max = 0.0;
+
+  // Sliding window; m_values is a ring of the last m_window samples and the
+  // two deques are rings of indices into it
+  std::size_t m_window;
+  std::vector<double> m_values;
+  std::uint64_t m_added = 0;
+  double m_window_mean = 0.0;
+  double m_window_m2 = 0.0;
+  std::vector<std::uint64_t> m_min_queue;
+  std::vector<std::uint64_t> m_max_queue;
+  std::size_t m_min_head = 0, m_min_tail = 0;
+  std::size_t m_max_head = 0, m_max_tail = 0;
+
+  [[nodiscard]] double valueAt(std::uint64_t index) const {
+    return m_values[index % m_window];
+  }
+
+  void addToWindow(double value);
+};
+
+#endif // RUNNINGSTATS_H
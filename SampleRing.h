@@ -0,0 +1,109 @@
+#ifndef SAMPLERING_H
+#define SAMPLERING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "Reading.h"
+
+// Bounded single-producer/single-consumer ring. The producer never blocks:
+// when the consumer has fallen behind and the ring is full, the new sample is
+// dropped and counted as an overrun. All storage is allocated up front.
+template <typename T> class SampleRing {
+public:
+  static constexpr std::size_t kCacheLine = 64;
+
+  // capacity is rounded up to a power of two
+  explicit SampleRing(const std::size_t capacity)
+      : m_capacity(roundUp(capacity)), m_mask(m_capacity - 1),
+        m_slots(new T[m_capacity]) {}
+
+  SampleRing(const SampleRing &) = delete;
+  SampleRing &operator=(const SampleRing &) = delete;
+
+  // Producer side
+  bool push(const T &sample) {
+    const std::size_t head = m_head.load(std::memory_order_relaxed);
+    if (head - m_cached_tail == m_capacity) {
+      m_cached_tail = m_tail.load(std::memory_order_acquire);
+      if (head - m_cached_tail == m_capacity) {
+        m_overruns.fetch_add(1, std::memory_order_relaxed);
+        return false;
+      }
+    }
+    m_slots[head & m_mask] = sample;
+    m_head.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer side
+  bool pop(T &sample) {
+    const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+    if (tail == m_cached_head) {
+      m_cached_head = m_head.load(std::memory_order_acquire);
+      if (tail == m_cached_head) {
+        return false;
+      }
+    }
+    sample = m_slots[tail & m_mask];
+    m_tail.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer side; returns the number of samples copied to out
+  std::size_t popBulk(T *out, const std::size_t max) {
+    const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+    m_cached_head = m_head.load(std::memory_order_acquire);
+    std::size_t n = m_cached_head - tail;
+    if (n > max) {
+      n = max;
+    }
+    for (std::size_t i = 0; i < n; ++i) {
+      out[i] = m_slots[(tail + i) & m_mask];
+    }
+    m_tail.store(tail + n, std::memory_order_release);
+    return n;
+  }
+
+  // Approximate when called from neither side
+  [[nodiscard]] std::size_t size() const {
+    // Tail first: the head read after it can only be further along
+    const std::size_t tail = m_tail.load(std::memory_order_acquire);
+    return m_head.load(std::memory_order_acquire) - tail;
+  }
+
+  [[nodiscard]] std::size_t capacity() const { return m_capacity; }
+
+  // Samples dropped because this ring's consumer was too slow
+  [[nodiscard]] std::uint64_t overruns() const {
+    return m_overruns.load(std::memory_order_relaxed);
+  }
+
+private:
+  static std::size_t roundUp(const std::size_t n) {
+    std::size_t capacity = 2;
+    while (capacity < n) {
+      capacity <<= 1;
+    }
+    return capacity;
+  }
+
+  const std::size_t m_capacity;
+  const std::size_t m_mask;
+  const std::unique_ptr<T[]> m_slots;
+
+  // Producer and consumer indices live on separate cache lines, each next to
+  // the side's private copy of the other index, so neither side bounces the
+  // other's line on every operation.
+  alignas(kCacheLine) std::atomic<std::size_t> m_head{0};
+  std::size_t m_cached_tail = 0;
+  std::atomic<std::uint64_t> m_overruns{0};
+  alignas(kCacheLine) std::atomic<std::size_t> m_tail{0};
+  std::size_t m_cached_head = 0;
+};
+
+using ReadingRing = SampleRing<Reading>;
+
+#endif // SAMPLERING_H
@@ -0,0 +1,122 @@
+#include "ScpiCommandQueue.h"
+
+#include <QDebug>
+#include <iostream>
+
+ScpiCommandQueue::ScpiCommandQueue(QObject *parent) : QObject(parent) {
+  m_clock.start();
+  m_deadline_timer = new QTimer(this);
+  m_deadline_timer->setSingleShot(true);
+  connect(m_deadline_timer, &QTimer::timeout, this,
+          &ScpiCommandQueue::onDeadline);
+}
+
+void ScpiCommandQueue::attach(QSerialPort *port) {
+  detach();
+  m_port = port;
+  m_framer.reset();
+  connect(m_port, &QSerialPort::readyRead, this,
+          &ScpiCommandQueue::onReadyRead);
+}
+
+void ScpiCommandQueue::detach() {
+  if (m_port) {
+    disconnect(m_port, nullptr, this, nullptr);
+    m_port = nullptr;
+  }
+  failAll();
+}
+
+void ScpiCommandQueue::statement(const QString &command) {
+  if (!m_port) {
+    std::cerr << "No port open, refusing writeSCPI\n";
+    return;
+  }
+  write(command);
+  ++m_statistics.statements;
+}
+
+void ScpiCommandQueue::query(const QString &command, ResponseHandler handler,
+                             const int timeoutMs) {
+  if (!m_port) {
+    std::cerr << "No port open, refusing writeSCPI\n";
+    handler(false, {});
+    return;
+  }
+  write(command);
+  ++m_statistics.queries;
+  m_in_flight.push_back({command, std::move(handler),
+                         m_clock.elapsed() + timeoutMs,
+                         m_clock.nsecsElapsed()});
+  if (m_in_flight.size() == 1) {
+    armDeadline();
+  }
+}
+
+void ScpiCommandQueue::write(const QString &command) {
+  // No flush() and no sleep: the port's write buffer drains as fast as the
+  // link allows while we go on queueing
+  const qint64 written =
+      m_port->write(QString(command + "\r\n").toLocal8Bit());
+  if (written > 0) {
+    m_statistics.bytesOut += written;
+  }
+}
+
+void ScpiCommandQueue::onReadyRead() {
+  m_statistics.bytesIn +=
+      m_framer.feed(m_port, [this](const QByteArray &line) { onLine(line); });
+  if (m_framer.pending() > 0) {
+    ++m_statistics.partialReads;
+  }
+}
+
+void ScpiCommandQueue::onLine(const QByteArray &line) {
+  if (m_in_flight.empty()) {
+    qDebug() << "Unsolicited response:" << line;
+    ++m_statistics.unsolicited;
+    return;
+  }
+  // Pop before calling out; the handler may queue more commands
+  const PendingQuery pending = std::move(m_in_flight.front());
+  m_in_flight.pop_front();
+  m_statistics.latencyFor(pending.command)
+      .record(m_clock.nsecsElapsed() - pending.sentNs);
+  armDeadline();
+  pending.handler(true, line);
+}
+
+void ScpiCommandQueue::onDeadline() {
+  if (m_in_flight.empty()) {
+    return;
+  }
+  if (m_in_flight.front().deadline > m_clock.elapsed()) {
+    armDeadline();
+    return;
+  }
+  // The meter answers strictly in order. Once one response is lost we can't
+  // tell which later line belongs to which query, so start over.
+  qDebug() << "Read timeout occurred for" << m_in_flight.front().command;
+  ++m_statistics.timeouts;
+  emit timedOut(m_in_flight.front().command);
+  m_framer.reset();
+  failAll();
+}
+
+void ScpiCommandQueue::failAll() {
+  m_deadline_timer->stop();
+  std::deque<PendingQuery> failed;
+  failed.swap(m_in_flight);
+  for (const auto &pending : failed) {
+    pending.handler(false, {});
+  }
+}
+
+void ScpiCommandQueue::armDeadline() {
+  if (m_in_flight.empty()) {
+    m_deadline_timer->stop();
+    return;
+  }
+  const qint64 remaining = m_in_flight.front().deadline - m_clock.elapsed();
+  m_deadline_timer->start(static_cast<int>(qMax<qint64>(0, remaining)));
+}
@@ -0,0 +1,78 @@
+#ifndef SCPICOMMANDQUEUE_H
+#define SCPICOMMANDQUEUE_H
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QObject>
+#include <QSerialPort>
+#include <QString>
+#include <QTimer>
+#include <deque>
+#include <functional>
+
+#include "IoStatistics.h"
+#include "ScpiLineFramer.h"
+
+// Pipelined SCPI transport on top of a QSerialPort. Statements and queries
+// are written back to back without waiting; queries are remembered in the
+// order they were sent and each response line is handed to the handler of
+// the oldest unanswered query.
+class ScpiCommandQueue final : public QObject {
+  Q_OBJECT
+
+public:
+  // ok is false if the query timed out or the port went away
+  using ResponseHandler = std::function<void(bool ok, const QByteArray &line)>;
+
+  explicit ScpiCommandQueue(QObject *parent = nullptr);
+
+  void attach(QSerialPort *port);
+
+  // Fails everything in flight and stops listening to the port
+  void detach();
+
+  void statement(const QString &command);
+
+  void query(const QString &command, ResponseHandler handler,
+             int timeoutMs = 500);
+
+  [[nodiscard]] int inFlight() const {
+    return static_cast<int>(m_in_flight.size());
+  }
+
+  // Always on; the owner adds what only it can see, e.g. decode failures
+  [[nodiscard]] IoStatistics &statistics() { return m_statistics; }
+
+signals:
+  void timedOut(const QString &command);
+
+private slots:
+  void onReadyRead();
+
+  void onDeadline();
+
+private:
+  struct PendingQuery {
+    QString command;
+    ResponseHandler handler;
+    qint64 deadline;
+    qint64 sentNs;
+  };
+
+  QSerialPort *m_port = nullptr;
+  ScpiLineFramer m_framer;
+  std::deque<PendingQuery> m_in_flight;
+  QElapsedTimer m_clock;
+  QTimer *m_deadline_timer = nullptr;
+  IoStatistics m_statistics;
+
+  void write(const QString &command);
+
+  void onLine(const QByteArray &line);
+
+  void failAll();
+
+  void armDeadline();
+};
+
+#endif // SCPICOMMANDQUEUE_H
@@ -0,0 +1,232 @@
+#include "ScpiDecoder.h"
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace {
+
+enum class Kind : std::uint8_t { Prefix, Unit };
+
+struct Token {
+  const char *text;
+  std::uint8_t length;
+  Kind kind;
+  std::int8_t exponent; // SI prefix, 0 for units
+  Unit unit;
+};
+
+// Everything that may follow the number. Grouped by lead byte, longest match
+// first within a group. GBK sequences are what the XDM1041 sends; the UTF-8
+// forms are accepted too so already-converted text decodes the same way.
+constexpr Token kTokens[] = {
+    {"p", 1, Kind::Prefix, -12, Unit::None},
+    {"n", 1, Kind::Prefix, -9, Unit::None},
+    {"u", 1, Kind::Prefix, -6, Unit::None},
+    {"m", 1, Kind::Prefix, -3, Unit::None},
+    {"k", 1, Kind::Prefix, 3, Unit::None},
+    {"M", 1, Kind::Prefix, 6, Unit::None},
+    {"G", 1, Kind::Prefix, 9, Unit::None},
+    {"V", 1, Kind::Unit, 0, Unit::Volt},
+    {"A", 1, Kind::Unit, 0, Unit::Ampere},
+    {"F", 1, Kind::Unit, 0, Unit::Farad},
+    {"Hz", 2, Kind::Unit, 0, Unit::Hertz},
+    {"HZ", 2, Kind::Unit, 0, Unit::Hertz},
+    {"s", 1, Kind::Unit, 0, Unit::Second},
+    {"K", 1, Kind::Unit, 0, Unit::Kelvin},
+    {"Ohm", 3, Kind::Unit, 0, Unit::Ohm},
+    {"OHM", 3, Kind::Unit, 0, Unit::Ohm},
+    // GBK
+    {"\xa6\xcc", 2, Kind::Prefix, -6, Unit::None}, // µ
+    {"\xa6\xb8", 2, Kind::Unit, 0, Unit::Ohm},     // Ω
+    {"\xa1\xe6", 2, Kind::Unit, 0, Unit::Celsius}, // ℃
+    {"\xa8\x48", 2, Kind::Unit, 0, Unit::Fahrenheit}, // ℉
+    // UTF-8
+    {"\xc2\xb5", 2, Kind::Prefix, -6, Unit::None},        // µ micro sign
+    {"\xc2\xb0" "C", 3, Kind::Unit, 0, Unit::Celsius},    // °C
+    {"\xc2\xb0" "F", 3, Kind::Unit, 0, Unit::Fahrenheit}, // °F
+    {"\xce\xbc", 2, Kind::Prefix, -6, Unit::None},        // μ greek mu
+    {"\xce\xa9", 2, Kind::Unit, 0, Unit::Ohm},            // Ω greek omega
+    {"\xe2\x84\x83", 3, Kind::Unit, 0, Unit::Celsius},    // ℃
+    {"\xe2\x84\x89", 3, Kind::Unit, 0, Unit::Fahrenheit}, // ℉
+    {"\xe2\x84\xa6", 3, Kind::Unit, 0, Unit::Ohm},        // Ω ohm sign
+};
+constexpr std::size_t kTokenCount = sizeof(kTokens) / sizeof(kTokens[0]);
+
+// Lead byte -> 1 + index of the first token starting with it, 0 if none
+constexpr std::array<std::uint8_t, 256> buildLeadIndex() {
+  std::array<std::uint8_t, 256> index{};
+  for (std::size_t i = kTokenCount; i-- > 0;) {
+    index[static_cast<unsigned char>(kTokens[i].text[0])] =
+        static_cast<std::uint8_t>(i + 1);
+  }
+  return index;
+}
+constexpr std::array<std::uint8_t, 256> kLeadIndex = buildLeadIndex();
+
+constexpr double kPow10[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+                             1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+                             1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+constexpr int kMaxPow10 = 22;
+
+double scale(double value, int exponent) {
+  // Dividing by an exact power of ten keeps 1.2345E-03 exact to the last bit
+  // more often than multiplying by an inexact 1e-3 would
+  while (exponent > kMaxPow10) {
+    value *= kPow10[kMaxPow10];
+    exponent -= kMaxPow10;
+  }
+  while (exponent < -kMaxPow10) {
+    value /= kPow10[kMaxPow10];
+    exponent += kMaxPow10;
+  }
+  return exponent >= 0 ? value * kPow10[exponent] : value / kPow10[-exponent];
+}
+
+const Token *matchToken(const char *p, const char *end) {
+  const std::uint8_t first = kLeadIndex[static_cast<unsigned char>(*p)];
+  if (first == 0) {
+    return nullptr;
+  }
+  for (std::size_t i = first - 1;
+       i < kTokenCount && kTokens[i].text[0] == *p; ++i) {
+    const Token &token = kTokens[i];
+    if (end - p >= token.length &&
+        std::memcmp(p, token.text, token.length) == 0) {
+      return &token;
+    }
+  }
+  return nullptr;
+}
+
+inline bool isDigit(const char c) { return c >= '0' && c <= '9'; }
+
+inline bool isSpace(const char c) {
+  return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+} // namespace
+
+ScpiDecoder::Result ScpiDecoder::decode(const char *data,
+                                        const std::size_t size) {
+  Result result;
+  const char *p = data;
+  const char *end = data + size;
+
+  while (p < end && isSpace(*p)) {
+    ++p;
+  }
+
+  bool negative = false;
+  if (p < end && (*p == '-' || *p == '+')) {
+    negative = *p == '-';
+    ++p;
+  }
+
+  if (end - p >= 2 && p[0] == 'O' && p[1] == 'L') {
+    result.ok = true;
+    result.overload = true;
+    result.value = negative ? -kOverloadValue : kOverloadValue;
+    p += 2;
+    while (p < end && isSpace(*p)) {
+      ++p;
+    }
+    if (p < end) {
+      if (const Token *token = matchToken(p, end)) {
+        result.unit = token->unit;
+      }
+    }
+    return result;
+  }
+
+  // Mantissa as an integer plus a decimal exponent; 19 digits fit a uint64
+  std::uint64_t mantissa = 0;
+  int digits = 0;
+  int exponent = 0;
+  bool seenDigit = false;
+  for (; p < end && isDigit(*p); ++p) {
+    seenDigit = true;
+    if (digits < 19) {
+      mantissa = mantissa * 10 + (*p - '0');
+      if (mantissa) {
+        ++digits;
+      }
+    } else {
+      ++exponent;
+    }
+  }
+  if (p < end && *p == '.') {
+    for (++p; p < end && isDigit(*p); ++p) {
+      seenDigit = true;
+      if (digits < 19) {
+        mantissa = mantissa * 10 + (*p - '0');
+        if (mantissa) {
+          ++digits;
+        }
+        --exponent;
+      }
+    }
+  }
+  if (!seenDigit) {
+    return result;
+  }
+
+  if (p < end && (*p == 'E' || *p == 'e')) {
+    const char *q = p + 1;
+    bool negativeExponent = false;
+    if (q < end && (*q == '-' || *q == '+')) {
+      negativeExponent = *q == '-';
+      ++q;
+    }
+    if (q < end && isDigit(*q)) {
+      int e = 0;
+      for (; q < end && isDigit(*q); ++q) {
+        if (e < 10000) {
+          e = e * 10 + (*q - '0');
+        }
+      }
+      exponent += negativeExponent ? -e : e;
+      p = q;
+    }
+  }
+
+  while (p < end && isSpace(*p)) {
+    ++p;
+  }
+
+  // At most one prefix followed by at most one unit
+  if (p < end) {
+    if (const Token *token = matchToken(p, end)) {
+      p += token->length;
+      if (token->kind == Kind::Prefix) {
+        exponent += token->exponent;
+        if (p < end) {
+          if (const Token *unit = matchToken(p, end);
+              unit && unit->kind == Kind::Unit) {
+            p += unit->length;
+            result.unit = unit->unit;
+          }
+        }
+      } else {
+        result.unit = token->unit;
+      }
+    }
+  }
+
+  while (p < end && isSpace(*p)) {
+    ++p;
+  }
+  if (p != end) {
+    return result; // trailing garbage
+  }
+
+  double value = scale(static_cast<double>(mantissa), exponent);
+  if (negative) {
+    value = -value;
+  }
+  result.ok = true;
+  result.value = value;
+  result.overload = std::fabs(value) >= kOverloadValue;
+  return result;
+}
@@ -0,0 +1,28 @@
+#ifndef SCPIDECODER_H
+#define SCPIDECODER_H
+
+#include <cstddef>
+
+#include "Reading.h"
+
+// Single-pass decoder for one response line from the meter. Understands both
+// the numeric form returned by MEAS1? ("1.2345E-03") and the display form of
+// MEAS1:SHOW? ("1.2345m\xa6\xb8", "25.3\xa1\xe6"), where units come as GBK
+// byte pairs. Works on the raw bytes, needs no terminating NUL and never
+// allocates.
+class ScpiDecoder {
+public:
+  struct Result {
+    bool ok = false;
+    double value = 0.0; // scaled to the base unit, prefix applied
+    Unit unit = Unit::None; // None if the line carried no unit
+    bool overload = false;
+  };
+
+  // Readings at or beyond this magnitude mean "OL" on the meter's display
+  static constexpr double kOverloadValue = 1e9;
+
+  static Result decode(const char *data, std::size_t size);
+};
+
+#endif // SCPIDECODER_H
@@ -0,0 +1,100 @@
+#ifndef SCPILINEFRAMER_H
+#define SCPILINEFRAMER_H
+
+#include <QByteArray>
+#include <QIODevice>
+#include <cstring>
+
+// Incremental splitter for newline-terminated SCPI responses. Bytes are read
+// straight from the device into a buffer that is reused across calls; each
+// complete line is handed to the callback without its "\r\n" terminator.
+// The QByteArray passed to the callback points into the internal buffer and
+// is only valid for the duration of the call.
+class ScpiLineFramer {
+public:
+  explicit ScpiLineFramer(const qsizetype maxLineLength = 4096)
+      : m_max_line_length(maxLineLength) {
+    m_buffer.resize(maxLineLength);
+  }
+
+  // Drain everything the device currently has buffered. Returns the number
+  // of bytes read.
+  template <typename LineHandler>
+  qint64 feed(QIODevice *device, LineHandler &&onLine) {
+    qint64 total = 0;
+    qint64 available;
+    while ((available = device->bytesAvailable()) > 0) {
+      reserve(available);
+      const qint64 got =
+          device->read(m_buffer.data() + m_end, m_buffer.size() - m_end);
+      if (got <= 0) {
+        break;
+      }
+      total += got;
+      m_end += got;
+      split(onLine);
+    }
+    return total;
+  }
+
+  template <typename LineHandler>
+  void append(const char *data, const qsizetype size, LineHandler &&onLine) {
+    reserve(size);
+    std::memcpy(m_buffer.data() + m_end, data, size);
+    m_end += size;
+    split(onLine);
+  }
+
+  // Drop any partial line, e.g. after a timeout or a reconnect.
+  void reset() { m_start = m_scan = m_end = 0; }
+
+  [[nodiscard]] qsizetype pending() const { return m_end - m_start; }
+
+private:
+  QByteArray m_buffer;
+  qsizetype m_max_line_length;
+  qsizetype m_start = 0; // first byte of the current partial line
+  qsizetype m_scan = 0;  // bytes before this are known not to be '\n'
+  qsizetype m_end = 0;   // end of valid data
+
+  void reserve(const qsizetype incoming) {
+    if (m_start > 0) {
+      // Move the partial line to the front; this is at most one line long
+      std::memmove(m_buffer.data(), m_buffer.constData() + m_start,
+                   m_end - m_start);
+      m_scan -= m_start;
+      m_end -= m_start;
+      m_start = 0;
+    }
+    if (m_end + incoming > m_buffer.size()) {
+      m_buffer.resize(m_end + incoming);
+    }
+  }
+
+  template <typename LineHandler> void split(LineHandler &onLine) {
+    const char *base = m_buffer.constData();
+    while (m_scan < m_end) {
+      const auto nl = static_cast<const char *>(
+          std::memchr(base + m_scan, '\n', m_end - m_scan));
+      if (!nl) {
+        m_scan = m_end;
+        break;
+      }
+      const qsizetype eol = nl - base;
+      qsizetype len = eol - m_start;
+      if (len > 0 && base[m_start + len - 1] == '\r') {
+        --len;
+      }
+      onLine(QByteArray::fromRawData(base + m_start, len));
+      m_start = m_scan = eol + 1;
+    }
+    if (m_start == m_end) {
+      m_start = m_scan = m_end = 0;
+    } else if (m_end - m_start > m_max_line_length) {
+      // Garbage without a terminator; don't let it grow without bound
+      reset();
+    }
+  }
+};
+
+#endif // SCPILINEFRAMER_H
@@ -0,0 +1,186 @@
+#include "ScpiProxy.h"
+
+#include "AcquisitionWorker.h"
+
+#include <algorithm>
+#include <iostream>
+
+ScpiProxy::ScpiProxy(AcquisitionWorker *worker, QObject *parent)
+    : QObject(parent), m_worker(worker) {
+  // Queued, since the worker lives on the acquisition thread
+  connect(m_worker, &AcquisitionWorker::proxyResponse, this,
+          &ScpiProxy::onResponse);
+}
+
+ScpiProxy::~ScpiProxy() { close(); }
+
+void ScpiProxy::listen(const QHostAddress &address, const quint16 port) {
+  close();
+  m_server = new QTcpServer(this);
+  if (!m_server->listen(address, port)) {
+    const QString message = "Could not listen on " + address.toString() + ":" +
+                            QString::number(port) + ": " +
+                            m_server->errorString();
+    delete m_server;
+    m_server = nullptr;
+    emit errorOccurred(message);
+    return;
+  }
+  connect(m_server, &QTcpServer::newConnection, this,
+          &ScpiProxy::onNewConnection);
+  std::cerr << "SCPI proxy on " << address.toString().toStdString() << ":"
+            << m_server->serverPort() << std::endl;
+  emit listening(m_server->serverPort());
+}
+
+void ScpiProxy::close() {
+  for (const auto &client : m_clients) {
+    client->socket->disconnect(this);
+    client->socket->abort();
+    client->socket->deleteLater();
+  }
+  m_clients.clear();
+  // Responses still on their way are dropped in onResponse
+  m_outstanding.clear();
+  if (m_server) {
+    m_server->close();
+    delete m_server;
+    m_server = nullptr;
+  }
+  if (m_coalesced > 0) {
+    std::cerr << "SCPI proxy merged " << m_coalesced << " queries"
+              << std::endl;
+    m_coalesced = 0;
+  }
+}
+
+void ScpiProxy::onNewConnection() {
+  while (QTcpSocket *socket = m_server->nextPendingConnection()) {
+    auto client = std::make_unique<Client>();
+    client->id = m_next_client_id++;
+    client->socket = socket;
+    Client *raw = client.get();
+    m_clients.push_back(std::move(client));
+
+    connect(socket, &QTcpSocket::readyRead, this,
+            [this, raw] { onReadyRead(raw); });
+    connect(socket, &QTcpSocket::disconnected, this,
+            [this, socket] { remove(socket); });
+  }
+}
+
+void ScpiProxy::onReadyRead(Client *client) {
+  client->input += client->socket->readAll();
+  qsizetype eol;
+  while ((eol = client->input.indexOf('\n')) >= 0) {
+    const QByteArray command = client->input.left(eol).trimmed();
+    client->input.remove(0, eol + 1);
+    if (!command.isEmpty()) {
+      client->commands.push_back(command);
+    }
+  }
+  if (client->input.size() > kMaxLineLength ||
+      client->commands.size() > kMaxQueuedCommands) {
+    std::cerr << "SCPI proxy client is not reading its responses, "
+                 "disconnecting"
+              << std::endl;
+    remove(client->socket);
+    return;
+  }
+  process(client);
+}
+
+void ScpiProxy::process(Client *client) {
+  while (!client->waiting && !client->commands.empty()) {
+    const QByteArray command = std::move(client->commands.front());
+    client->commands.pop_front();
+    if (command.contains('?')) {
+      forwardQuery(client, command);
+      continue;
+    }
+    // Whatever is in flight may have been answered before this takes
+    // effect, so later queries must not join it
+    for (auto &outstanding : m_outstanding) {
+      outstanding.joinable = false;
+    }
+    QMetaObject::invokeMethod(
+        m_worker,
+        [worker = m_worker, command = QString::fromLatin1(command)] {
+          worker->sendStatement(command);
+        },
+        Qt::QueuedConnection);
+  }
+}
+
+void ScpiProxy::forwardQuery(Client *client, const QByteArray &command) {
+  client->waiting = true;
+  const QByteArray key = command.toUpper();
+  const qint64 now = Reading::now();
+  const auto it = std::find_if(
+      m_outstanding.begin(), m_outstanding.end(),
+      [&key, now](const Outstanding &outstanding) {
+        return outstanding.joinable && outstanding.key == key &&
+               now - outstanding.sentNs <
+                   AcquisitionWorker::kCoalesceMs * 1000000LL;
+      });
+  if (it != m_outstanding.end()) {
+    it->waiters.push_back(client->id);
+    ++m_coalesced;
+    return;
+  }
+
+  const quint64 id = m_next_id++;
+  m_outstanding.push_back({id, key, now, true, {client->id}});
+  QMetaObject::invokeMethod(
+      m_worker,
+      [worker = m_worker, id, command = QString::fromLatin1(command)] {
+        worker->proxyQuery(id, command);
+      },
+      Qt::QueuedConnection);
+}
+
+void ScpiProxy::onResponse(const quint64 id, const bool ok,
+                           const QByteArray &line) {
+  const auto it =
+      std::find_if(m_outstanding.begin(), m_outstanding.end(),
+                   [id](const Outstanding &outstanding) {
+                     return outstanding.id == id;
+                   });
+  if (it == m_outstanding.end()) {
+    return;
+  }
+  const std::vector<quint64> waiters = std::move(it->waiters);
+  m_outstanding.erase(it);
+
+  for (const quint64 clientId : waiters) {
+    Client *client = find(clientId);
+    if (!client) {
+      continue; // went away while waiting
+    }
+    if (ok) {
+      client->socket->write(line + "\r\n");
+    }
+    client->waiting = false;
+    process(client);
+  }
+}
+
+ScpiProxy::Client *ScpiProxy::find(const quint64 clientId) const {
+  const auto it = std::find_if(
+      m_clients.begin(), m_clients.end(),
+      [clientId](const auto &client) { return client->id == clientId; });
+  return it != m_clients.end() ? it->get() : nullptr;
+}
+
+void ScpiProxy::remove(QTcpSocket *socket) {
+  const auto it = std::find_if(
+      m_clients.begin(), m_clients.end(),
+      [socket](const auto &client) { return client->socket == socket; });
+  if (it == m_clients.end()) {
+    return;
+  }
+  m_clients.erase(it);
+  socket->disconnect(this);
+  socket->abort();
+  socket->deleteLater();
+}
@@ -0,0 +1,95 @@
+#ifndef SCPIPROXY_H
+#define SCPIPROXY_H
+
+#include <QByteArray>
+#include <QHostAddress>
+#include <QObject>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <deque>
+#include <memory>
+#include <vector>
+
+class AcquisitionWorker;
+
+// Lets several local programs talk SCPI to a meter whose serial port this
+// app already owns. Clients connect over TCP and send newline terminated
+// commands as they would on the serial line. Each client's commands are
+// passed on strictly in order; a query holds back that client's following
+// commands until it is answered, and everything goes through the worker's
+// ScpiCommandQueue so responses stay matched to the right query even with
+// the worker's own polls in between.
+//
+// A query equal to one another client sent less than
+// AcquisitionWorker::kCoalesceMs ago, and still unanswered, is not sent
+// again; both clients get the one response. Any statement ends that, since
+// it may change what the meter would answer.
+//
+// A query the meter does not answer gets no reply, like on the serial line.
+class ScpiProxy final : public QObject {
+  Q_OBJECT
+
+public:
+  // Per client; a client sending more than this without reading is dropped
+  static constexpr std::size_t kMaxQueuedCommands = 256;
+  static constexpr qsizetype kMaxLineLength = 1024;
+
+  explicit ScpiProxy(AcquisitionWorker *worker, QObject *parent = nullptr);
+
+  ~ScpiProxy() override;
+
+public slots:
+  void listen(const QHostAddress &address, quint16 port);
+
+  void close();
+
+signals:
+  void listening(quint16 port);
+
+  void errorOccurred(const QString &message);
+
+private slots:
+  void onNewConnection();
+
+  void onResponse(quint64 id, bool ok, const QByteArray &line);
+
+private:
+  struct Client {
+    // Never reused, unlike the socket's address
+    quint64 id;
+    QTcpSocket *socket;
+    QByteArray input;
+    std::deque<QByteArray> commands;
+    bool waiting = false;
+  };
+
+  // A query handed to the worker and not answered yet
+  struct Outstanding {
+    quint64 id;
+    QByteArray key; // upper case, for coalescing
+    qint64 sentNs;
+    bool joinable;
+    std::vector<quint64> waiters; // Client::id
+  };
+
+  AcquisitionWorker *m_worker;
+  QTcpServer *m_server = nullptr;
+  std::vector<std::unique_ptr<Client>> m_clients;
+  std::vector<Outstanding> m_outstanding;
+  quint64 m_next_id = 1;
+  quint64 m_next_client_id = 1;
+  quint64 m_coalesced = 0;
+
+  void onReadyRead(Client *client);
+
+  // Passes on commands until the client waits for a response
+  void process(Client *client);
+
+  void forwardQuery(Client *client, const QByteArray &command);
+
+  Client *find(quint64 clientId) const;
+
+  void remove(QTcpSocket *socket);
+};
+
+#endif // SCPIPROXY_H
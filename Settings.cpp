@@ -1,12 +1,55 @@
 #include "Settings.h"
 
+#include <QCoreApplication>
 #include <iostream>
 
-Settings::Settings(QObject *parent) : QSettings(parent) {}
+Settings::Settings(QObject *parent) : QSettings(parent) { setupFlushTimer(); }
 
 Settings::Settings(const QString &organization, const QString &application,
                    QObject *parent)
-    : QSettings(organization, application, parent) {}
+    : QSettings(organization, application, parent) {
+  setupFlushTimer();
+}
+
+Settings::~Settings() { flush(); }
+
+void Settings::setupFlushTimer() {
+  m_flush_timer = new QTimer(this);
+  m_flush_timer->setSingleShot(true);
+  m_flush_timer->setInterval(kFlushDelayMs);
+  connect(m_flush_timer, &QTimer::timeout, this, &Settings::flush);
+  // Last chance before the event loop goes away
+  if (QCoreApplication::instance()) {
+    connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit, this,
+            &Settings::flush);
+  }
+}
+
+void Settings::defer(const QString &key, const QVariant &value) {
+  m_pending.insert(key, value);
+  // Restarting pushes the write out until changes stop coming in
+  m_flush_timer->start();
+}
+
+QVariant Settings::current(const QString &key,
+                           const QVariant &defaultValue) const {
+  const auto it = m_pending.constFind(key);
+  return it != m_pending.constEnd() ? *it : value(key, defaultValue);
+}
+
+void Settings::flush() {
+  m_flush_timer->stop();
+  if (m_pending.isEmpty()) {
+    return;
+  }
+  for (auto it = m_pending.constBegin(); it != m_pending.constEnd(); ++it) {
+    setValue(it.key(), it.value());
+  }
+  std::cerr << "Settings saved (" << m_pending.size() << " keys)."
+            << std::endl;
+  m_pending.clear();
+  sync();
+}
 
 void Settings::init() { load(); }
 
@@ -22,82 +65,149 @@ void Settings::load() {
   m_beep_short = value("beep_short", m_beep_short).toBool();
   m_beep_diode = value("beep_diode", m_beep_diode).toBool();
   m_beep_resistance = value("beep_threshold", m_beep_resistance).toInt();
+  m_listen_address =
+      value("network/listen", m_listen_address).toString();
+  m_stream_port = value("network/stream_port", m_stream_port).toInt();
+  m_metrics_port = value("network/metrics_port", m_metrics_port).toInt();
+  m_proxy_port = value("network/proxy_port", m_proxy_port).toInt();
 }
 
 void Settings::save() {
-  // Save settings to storage using QSettings methods
-  setValue("window/height", m_windowHeight);
-  setValue("window/width", m_windowWidth);
-  setValue("window/x", m_windowX);
-  setValue("window/y", m_windowY);
-  setValue("hardware/device", m_device);
-  setValue("rate", rateToString(m_rate)); // Save rate
-  setValue("beep_short", m_beep_short);
-  setValue("beep_diode", m_beep_diode);
-  setValue("beep_threshold", m_beep_resistance);
-
-  // Ensure settings are written to disk
-  std::cerr << "Settings saved." << std::endl;
-  sync();
+  // Only what changed since the last flush gets written
+  flush();
 }
 
-// Setter methods with automatic value updates
+// Setters update the cached value right away and write it out later
 void Settings::setWindowHeight(const int height) {
+  if (m_windowHeight == height) {
+    return;
+  }
   m_windowHeight = height;
-  setValue("window/height", height);
+  defer("window/height", height);
 }
 
 void Settings::setWindowWidth(const int width) {
+  if (m_windowWidth == width) {
+    return;
+  }
   m_windowWidth = width;
-  setValue("window/width", width);
+  defer("window/width", width);
 }
 
 void Settings::setWindowX(const int x) {
+  if (m_windowX == x) {
+    return;
+  }
   m_windowX = x;
-  setValue("window/x", x);
+  defer("window/x", x);
 }
 
 void Settings::setWindowY(const int y) {
+  if (m_windowY == y) {
+    return;
+  }
   m_windowY = y;
-  setValue("window/y", y);
+  defer("window/y", y);
 }
 
 void Settings::setDevice(const QString &device) {
   m_device = device;
-  setValue("hardware/device", device);
+  defer("hardware/device", device);
 }
 
 void Settings::setRate(Rate rate) {
   // Added implementation for setRate
   if (m_rate != rate) {
     m_rate = rate;
-    setValue("rate", rateToString(rate));
-    // You might want to call sync() here if you want immediate persistence
-    // or rely on the global save() method.
+    defer("rate", rateToString(rate));
   }
 }
 
 void Settings::setBeepShort(bool enabled) {
   if (m_beep_short != enabled) {
     m_beep_short = enabled;
-    setValue("beep_short", m_beep_short);
+    defer("beep_short", m_beep_short);
   }
 }
 
 void Settings::setBeepDiode(bool enabled) {
   if (m_beep_diode != enabled) {
     m_beep_diode = enabled;
-    setValue("beep_diode", m_beep_diode);
+    defer("beep_diode", m_beep_diode);
   }
 }
 
 void Settings::setBeepResistance(int threshold) {
   if (m_beep_resistance != threshold) {
     m_beep_resistance = threshold;
-    setValue("beep_threshold", m_beep_resistance);
+    defer("beep_threshold", m_beep_resistance);
   }
 }
 
+QString Settings::deviceGroup(const QString &device) {
+  QString key = device;
+  key.replace('/', '_').replace('\\', '_');
+  return "devices/" + key;
+}
+
+Settings::DeviceSettings Settings::deviceSettings(const QString &device) {
+  DeviceSettings settings{m_rate, m_beep_short, m_beep_diode,
+                          m_beep_resistance};
+  const QString group = deviceGroup(device) + "/";
+  settings.rate = stringToRate(
+      current(group + "rate", rateToString(settings.rate)).toString(),
+      settings.rate);
+  settings.beepShort =
+      current(group + "beep_short", settings.beepShort).toBool();
+  settings.beepDiode =
+      current(group + "beep_diode", settings.beepDiode).toBool();
+  settings.beepResistance =
+      current(group + "beep_threshold", settings.beepResistance).toInt();
+  return settings;
+}
+
+void Settings::setDeviceSettings(const QString &device,
+                                 const DeviceSettings &settings) {
+  QStringList known = devices();
+  if (!known.contains(device)) {
+    known.append(device);
+    defer("devices/list", known);
+  }
+  const QString group = deviceGroup(device) + "/";
+  defer(group + "port", device);
+  defer(group + "rate", rateToString(settings.rate));
+  defer(group + "beep_short", settings.beepShort);
+  defer(group + "beep_diode", settings.beepDiode);
+  defer(group + "beep_threshold", settings.beepResistance);
+}
+
+MeasurementMode Settings::lastMode(const QString &device) {
+  const int mode =
+      current(deviceGroup(device) + "/mode",
+              static_cast<int>(MeasurementMode::VoltageDC))
+          .toInt();
+  if (mode <= static_cast<int>(MeasurementMode::Unknown) ||
+      mode > static_cast<int>(MeasurementMode::Temperature)) {
+    return MeasurementMode::VoltageDC;
+  }
+  return static_cast<MeasurementMode>(mode);
+}
+
+QString Settings::lastRange(const QString &device) {
+  return current(deviceGroup(device) + "/range", "50").toString();
+}
+
+void Settings::setLastMode(const QString &device, const MeasurementMode mode,
+                           const QString &range) {
+  const QString group = deviceGroup(device) + "/";
+  defer(group + "mode", static_cast<int>(mode));
+  defer(group + "range", range);
+}
+
+QStringList Settings::devices() {
+  return current("devices/list").toStringList();
+}
+
 Settings::Rate Settings::stringToRate(QString value, Rate dflt) {
   static const std::map<std::string, Rate> enumMap = {
       {"slow", Rate::SLOW}, {"medium", Rate::MEDIUM}, {"fast", Rate::FAST}};
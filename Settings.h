@@ -1,27 +1,53 @@
 #ifndef SETTINGS_H
 #define SETTINGS_H
 
+#include <QHash>
 #include <QSettings>
 #include <QString>
+#include <QStringList>
+#include <QTimer>
+#include <QVariant>
 #include <map> // Required for std::map in .cpp
 
+#include "Reading.h"
+
+// Setters are write-behind: they update the cached value immediately, mark
+// the key dirty and restart a short quiet-period timer. Dragging the window
+// edge thus ends up as one write instead of hundreds. flush() (also run by
+// save(), on quit and on destruction) writes only the dirty keys.
 class Settings : public QSettings {
   Q_OBJECT
 
 public:
   enum class Rate { SLOW, MEDIUM, FAST };
 
+  static constexpr int kFlushDelayMs = 2000;
+
+  // Per-meter settings, stored under devices/<port>/. A meter without its
+  // own group inherits the top-level values.
+  struct DeviceSettings {
+    Rate rate;
+    bool beepShort;
+    bool beepDiode;
+    int beepResistance;
+  };
+
   explicit Settings(QObject *parent = nullptr);
 
   Settings(const QString &organization, const QString &application,
            QObject *parent = nullptr);
 
+  ~Settings() override;
+
   void init();
 
   void load();
 
   void save();
 
+  // Write pending changes now
+  void flush();
+
   // Getter methods
   int windowHeight() const { return m_windowHeight; }
   int windowWidth() const { return m_windowWidth; }
@@ -33,6 +59,13 @@ public:
   bool getBeepDiode() const { return m_beep_diode; }
   int getBeepResistance() const { return m_beep_resistance; }
 
+  // Local services; a port of 0 leaves the service off. Not in the UI yet,
+  // set them in the settings file.
+  QString listenAddress() const { return m_listen_address; }
+  int streamPort() const { return m_stream_port; }
+  int metricsPort() const { return m_metrics_port; }
+  int proxyPort() const { return m_proxy_port; }
+
   // Setter methods
   void setWindowHeight(int height);
 
@@ -51,13 +84,45 @@ public:
 
   void setBeepResistance(int threshold);
 
+  DeviceSettings deviceSettings(const QString &device);
+
+  void setDeviceSettings(const QString &device,
+                         const DeviceSettings &settings);
+
+  // Function and range the meter was last switched to, restored on the
+  // next connect; 50 V DC the first time
+  MeasurementMode lastMode(const QString &device);
+
+  QString lastRange(const QString &device);
+
+  void setLastMode(const QString &device, MeasurementMode mode,
+                   const QString &range);
+
+  // Ports that have a group of their own, in the order they were added
+  QStringList devices();
+
   static Rate stringToRate(QString value, Rate dflt);
 
   static QString rateToString(Rate rate);
 
 private:
+  QTimer *m_flush_timer = nullptr;
+  // Changes not yet handed to QSettings; a later change to the same key
+  // simply replaces the earlier one
+  QHash<QString, QVariant> m_pending;
+
+  void setupFlushTimer();
+
+  void defer(const QString &key, const QVariant &value);
+
+  // Pending value if there is one, else what is stored
+  QVariant current(const QString &key, const QVariant &defaultValue = {}) const;
+
+  // Port names contain '/', which QSettings would take as nesting
+  static QString deviceGroup(const QString &device);
+
   // Default values (can be overridden by loaded settings)
-  int m_windowHeight = 162;
+  int m_windowHeight = 320;
   int m_windowWidth = 580;
   int m_windowX = 100;
   int m_windowY = 100;
@@ -66,6 +131,10 @@ private:
   bool m_beep_short = true;
   bool m_beep_diode = true;
   int m_beep_resistance = 50;
+  QString m_listen_address = "127.0.0.1";
+  int m_stream_port = 0;
+  int m_metrics_port = 0;
+  int m_proxy_port = 0;
 };
 
 #endif // SETTINGS_H
@@ -0,0 +1,188 @@
+#include "StreamServer.h"
+
+#include "ReadingFormat.h"
+
+#include <QDateTime>
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+
+StreamServer::StreamServer(QObject *parent)
+    : QObject(parent), m_ring(std::make_shared<ReadingRing>(kRingCapacity)),
+      m_readings(1024) {}
+
+StreamServer::~StreamServer() { close(); }
+
+void StreamServer::listen(const QHostAddress &address, const quint16 port,
+                          const qint64 epochNs) {
+  close();
+  m_epoch_ns = epochNs;
+  // Wall clock at the epoch, for the binary header
+  m_epoch_ms = QDateTime::currentMSecsSinceEpoch() -
+               (Reading::now() - epochNs) / 1000000;
+
+  m_server = new QTcpServer(this);
+  if (!m_server->listen(address, port)) {
+    const QString message = "Could not listen on " + address.toString() + ":" +
+                            QString::number(port) + ": " +
+                            m_server->errorString();
+    delete m_server;
+    m_server = nullptr;
+    emit errorOccurred(message);
+    return;
+  }
+  connect(m_server, &QTcpServer::newConnection, this,
+          &StreamServer::onNewConnection);
+
+  if (!m_timer) {
+    m_timer = new QTimer(this);
+    m_timer->setInterval(kDrainIntervalMs);
+    connect(m_timer, &QTimer::timeout, this, &StreamServer::drain);
+  }
+  m_timer->start();
+  std::cerr << "Streaming readings on " << address.toString().toStdString()
+            << ":" << m_server->serverPort() << std::endl;
+  emit listening(m_server->serverPort());
+}
+
+void StreamServer::close() {
+  if (m_timer) {
+    m_timer->stop();
+  }
+  for (const auto &subscriber : m_subscribers) {
+    subscriber->socket->disconnect(this);
+    subscriber->socket->abort();
+    subscriber->socket->deleteLater();
+  }
+  m_subscribers.clear();
+  if (m_server) {
+    m_server->close();
+    delete m_server;
+    m_server = nullptr;
+  }
+}
+
+void StreamServer::onNewConnection() {
+  while (QTcpSocket *socket = m_server->nextPendingConnection()) {
+    auto subscriber = std::make_unique<Subscriber>();
+    subscriber->socket = socket;
+    subscriber->queue.resize(kSubscriberQueue);
+    Subscriber *raw = subscriber.get();
+    m_subscribers.push_back(std::move(subscriber));
+
+    connect(socket, &QTcpSocket::readyRead, this,
+            [this, raw] { onReadyRead(raw); });
+    connect(socket, &QTcpSocket::bytesWritten, this,
+            [this, raw] { flush(raw); });
+    connect(socket, &QTcpSocket::disconnected, this,
+            [this, socket] { remove(socket); });
+    sendGreeting(raw);
+  }
+}
+
+void StreamServer::sendGreeting(Subscriber *subscriber) const {
+  if (subscriber->binary) {
+    RecordingHeader header = RecordingHeader::make();
+    header.startTimestampNs = m_epoch_ns;
+    header.startEpochMs = m_epoch_ms;
+    subscriber->socket->write(reinterpret_cast<const char *>(&header),
+                              sizeof(header));
+  } else {
+    subscriber->socket->write("device,time_s,value,unit,overload\n");
+  }
+}
+
+void StreamServer::onReadyRead(Subscriber *subscriber) {
+  subscriber->input += subscriber->socket->readAll();
+  qsizetype eol;
+  while ((eol = subscriber->input.indexOf('\n')) >= 0) {
+    const QByteArray command =
+        subscriber->input.left(eol).trimmed().toUpper();
+    subscriber->input.remove(0, eol + 1);
+    if (command == "FORMAT BINARY" || command == "FORMAT TEXT") {
+      const bool binary = command == "FORMAT BINARY";
+      if (binary != subscriber->binary) {
+        // Finish the current format before switching
+        flush(subscriber);
+        subscriber->binary = binary;
+        sendGreeting(subscriber);
+      }
+    }
+  }
+  if (subscriber->input.size() > 1024) {
+    subscriber->input.clear(); // not a client we understand
+  }
+}
+
+void StreamServer::remove(QTcpSocket *socket) {
+  const auto it = std::find_if(
+      m_subscribers.begin(), m_subscribers.end(),
+      [socket](const auto &subscriber) { return subscriber->socket == socket; });
+  if (it == m_subscribers.end()) {
+    return;
+  }
+  if ((*it)->dropped > 0) {
+    std::cerr << "Stream client dropped " << (*it)->dropped
+              << " readings it could not keep up with" << std::endl;
+  }
+  m_subscribers.erase(it);
+  socket->disconnect(this);
+  socket->deleteLater();
+}
+
+void StreamServer::drain() {
+  std::size_t count;
+  while ((count = m_ring->popBulk(m_readings.data(), m_readings.size())) > 0) {
+    for (const auto &subscriber : m_subscribers) {
+      Subscriber &s = *subscriber;
+      for (std::size_t i = 0; i < count; ++i) {
+        if (s.size == s.queue.size()) {
+          // Drop the oldest
+          s.head = (s.head + 1) % s.queue.size();
+          --s.size;
+          ++s.dropped;
+        }
+        s.queue[(s.head + s.size) % s.queue.size()] = m_readings[i];
+        ++s.size;
+      }
+    }
+  }
+  for (const auto &subscriber : m_subscribers) {
+    flush(subscriber.get());
+  }
+}
+
+void StreamServer::flush(Subscriber *subscriber) {
+  Subscriber &s = *subscriber;
+  QByteArray &out = s.output;
+  while (s.size > 0 && s.socket->bytesToWrite() < kSocketBacklog) {
+    out.clear();
+    // Write in slices so one busy client does not hog the thread
+    const std::size_t slice = std::min<std::size_t>(s.size, 512);
+    for (std::size_t i = 0; i < slice; ++i) {
+      const Reading &reading = s.queue[s.head];
+      s.head = (s.head + 1) % s.queue.size();
+      if (s.binary) {
+        RecordingRecord record{};
+        record.offsetNs = reading.timestampNs - m_epoch_ns;
+        record.value = reading.value;
+        record.mode = static_cast<std::uint8_t>(reading.mode);
+        record.unit = static_cast<std::uint8_t>(reading.unit);
+        record.flags = (reading.overload ? RecordingRecord::Overload : 0) |
+                       (reading.gap ? RecordingRecord::Gap : 0);
+        record.device = reading.device + 1u;
+        out.append(reinterpret_cast<const char *>(&record), sizeof(record));
+      } else {
+        char line[96];
+        const int length = std::snprintf(
+            line, sizeof(line), "%d,%.6f,%.9g,", reading.device + 1,
+            (reading.timestampNs - m_epoch_ns) / 1e9, reading.value);
+        out.append(line, length);
+        out.append(unitSymbol(reading.unit).toUtf8());
+        out.append(reading.overload ? ",1\n" : ",0\n");
+      }
+    }
+    s.size -= slice;
+    s.socket->write(out);
+  }
+}
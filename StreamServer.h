@@ -0,0 +1,94 @@
+#ifndef STREAMSERVER_H
+#define STREAMSERVER_H
+
+#include <QByteArray>
+#include <QHostAddress>
+#include <QObject>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+#include <memory>
+#include <vector>
+
+#include "RecordingFormat.h"
+#include "SampleRing.h"
+
+// Pushes every reading to any number of TCP subscribers. Lives in its own
+// thread and drains its ring like the recorder does. Each subscriber has a
+// fixed-size queue that drops its oldest entries when the client cannot
+// keep up, and the socket is only fed while its send buffer is short, so a
+// stalled client costs a bounded amount of memory and never slows
+// acquisition or the other clients.
+//
+// Protocol: on connect the server sends a CSV header line and then one line
+// per reading, "device,time_s,value,unit,overload". A client that sends
+// "FORMAT BINARY" gets a RecordingHeader followed by RecordingRecords
+// instead, i.e. exactly a .owr file, where RecordingRecord::device carries
+// the same 1-based number as the text format; "FORMAT TEXT" switches back.
+class StreamServer final : public QObject {
+  Q_OBJECT
+
+public:
+  static constexpr std::size_t kRingCapacity = 16384;
+  // Per subscriber, in readings
+  static constexpr std::size_t kSubscriberQueue = 8192;
+  // Stop handing data to a socket once this much is waiting to be sent
+  static constexpr qint64 kSocketBacklog = 64 * 1024;
+  static constexpr int kDrainIntervalMs = 20;
+
+  explicit StreamServer(QObject *parent = nullptr);
+
+  ~StreamServer() override;
+
+  // Attach this to the acquisition workers
+  [[nodiscard]] std::shared_ptr<ReadingRing> ring() const { return m_ring; }
+
+public slots:
+  // Readings are timed relative to epochNs (steady clock)
+  void listen(const QHostAddress &address, quint16 port, qint64 epochNs);
+
+  void close();
+
+signals:
+  void listening(quint16 port);
+
+  void errorOccurred(const QString &message);
+
+private slots:
+  void onNewConnection();
+
+  void drain();
+
+private:
+  struct Subscriber {
+    QTcpSocket *socket;
+    // Fixed ring; when full the oldest reading is overwritten
+    std::vector<Reading> queue;
+    std::size_t head = 0;
+    std::size_t size = 0;
+    quint64 dropped = 0;
+    bool binary = false;
+    QByteArray input;
+    QByteArray output;
+  };
+
+  std::shared_ptr<ReadingRing> m_ring;
+  std::vector<Reading> m_readings;
+  std::vector<std::unique_ptr<Subscriber>> m_subscribers;
+  QTcpServer *m_server = nullptr;
+  QTimer *m_timer = nullptr;
+  qint64 m_epoch_ns = 0;
+  qint64 m_epoch_ms = 0;
+
+  void onReadyRead(Subscriber *subscriber);
+
+  void remove(QTcpSocket *socket);
+
+  // Moves as much of the subscriber's queue into its socket as the backlog
+  // limit allows
+  void flush(Subscriber *subscriber);
+
+  void sendGreeting(Subscriber *subscriber) const;
+};
+
+#endif // STREAMSERVER_H
@@ -0,0 +1,139 @@
+#include "TrendChart.h"
+
+#include <QMouseEvent>
+#include <QPainter>
+#include <QWheelEvent>
+#include <algorithm>
+#include <cmath>
+
+#include "ReadingFormat.h"
+
+TrendChart::TrendChart(QWidget *parent)
+    : QWidget(parent), m_history(kHistory) {
+  setAttribute(Qt::WA_OpaquePaintEvent, true);
+  setToolTip("Mouse wheel zooms, double click shows everything");
+}
+
+void TrendChart::addReading(const Reading &reading) {
+  // A different function makes the old history meaningless on this scale
+  if (reading.mode != m_mode || reading.unit != m_unit) {
+    m_history.clear();
+    m_mode = reading.mode;
+    m_unit = reading.unit;
+  }
+  if (reading.overload) {
+    return;
+  }
+  m_history.push(static_cast<float>(reading.value));
+}
+
+void TrendChart::clear() {
+  m_history.clear();
+  update();
+}
+
+void TrendChart::paintEvent(QPaintEvent *event) {
+  Q_UNUSED(event);
+  QPainter painter(this);
+  const QRect frame = rect().adjusted(0, 0, -1, -1);
+  painter.fillRect(rect(), palette().base());
+  painter.setPen(palette().mid().color());
+  painter.drawRect(frame);
+
+  const std::uint64_t total = m_history.total();
+  const std::uint64_t kept = total - m_history.first();
+  const std::uint64_t span =
+      m_visible == 0 ? kept : std::min<std::uint64_t>(m_visible, kept);
+  if (span < 2) {
+    return;
+  }
+  const std::uint64_t start = total - span;
+
+  const MinMaxPyramid::Range overall = m_history.range(start, total);
+  if (!overall.valid) {
+    return;
+  }
+  double low = overall.min;
+  double high = overall.max;
+  if (high - low < 1e-12) {
+    const double pad = std::max(std::abs(high) * 0.01, 1e-6);
+    low -= pad;
+    high += pad;
+  }
+
+  const QRectF plot = QRectF(frame).adjusted(2, 2, -2, -2);
+  const double yScale = plot.height() / (high - low);
+  auto yOf = [&](const double value) {
+    return plot.bottom() - (value - low) * yScale;
+  };
+
+  m_lines.clear();
+  const int columns = static_cast<int>(plot.width());
+  if (span <= static_cast<std::uint64_t>(columns)) {
+    // Fewer samples than pixels: plain polyline through every sample
+    const double xStep = plot.width() / static_cast<double>(span - 1);
+    QPointF previous;
+    for (std::uint64_t i = 0; i < span; ++i) {
+      const float value = m_history.range(start + i, start + i + 1).min;
+      const QPointF point(plot.left() + i * xStep, yOf(value));
+      if (i > 0) {
+        m_lines.append(QLineF(previous, point));
+      }
+      previous = point;
+    }
+  } else {
+    // One vertical min/max bar per column, joined to its neighbour so the
+    // trace stays continuous
+    MinMaxPyramid::Range previous{0, 0, false};
+    for (int x = 0; x < columns; ++x) {
+      const std::uint64_t a = start + span * x / columns;
+      const std::uint64_t b = start + span * (x + 1) / columns;
+      const MinMaxPyramid::Range column = m_history.range(a, b);
+      if (!column.valid) {
+        continue;
+      }
+      const double px = plot.left() + x;
+      m_lines.append(QLineF(px, yOf(column.min), px, yOf(column.max)));
+      if (previous.valid) {
+        if (previous.max < column.min) {
+          m_lines.append(QLineF(px - 1, yOf(previous.max), px, yOf(column.min)));
+        } else if (previous.min > column.max) {
+          m_lines.append(QLineF(px - 1, yOf(previous.min), px, yOf(column.max)));
+        }
+      }
+      previous = column;
+    }
+  }
+
+  painter.setPen(palette().text().color());
+  painter.drawLines(m_lines);
+
+  Reading label;
+  label.unit = m_unit;
+  painter.setPen(palette().mid().color());
+  label.value = overall.max;
+  painter.drawText(plot, Qt::AlignLeft | Qt::AlignTop, formatReading(label));
+  label.value = overall.min;
+  painter.drawText(plot, Qt::AlignLeft | Qt::AlignBottom, formatReading(label));
+  painter.drawText(plot, Qt::AlignRight | Qt::AlignTop,
+                   QString::number(span) + " samples");
+}
+
+void TrendChart::wheelEvent(QWheelEvent *event) {
+  const std::uint64_t kept = m_history.total() - m_history.first();
+  std::uint64_t visible = m_visible == 0 ? kept : m_visible;
+  if (event->angleDelta().y() > 0) {
+    visible = std::max(visible / 2, kMinVisible);
+  } else if (event->angleDelta().y() < 0) {
+    visible *= 2;
+  }
+  m_visible = visible >= kept ? 0 : visible;
+  update();
+  event->accept();
+}
+
+void TrendChart::mouseDoubleClickEvent(QMouseEvent *event) {
+  m_visible = 0;
+  update();
+  event->accept();
+}
@@ -0,0 +1,170 @@
+#include "TriggerEngine.h"
+
+#include <cmath>
+#include <cstdlib>
+
+bool TriggerEngine::parse(const std::string &spec, Condition &condition,
+                          std::string &error) {
+  const std::size_t colon = spec.find(':');
+  if (colon == std::string::npos) {
+    error = "Trigger needs a kind and a value, e.g. below:4.75";
+    return false;
+  }
+  const std::string kind = spec.substr(0, colon);
+
+  std::vector<double> values;
+  const char *cursor = spec.c_str() + colon + 1;
+  while (true) {
+    char *end = nullptr;
+    const double value = std::strtod(cursor, &end);
+    if (end == cursor) {
+      error = "Invalid trigger value in " + spec;
+      return false;
+    }
+    values.push_back(value);
+    if (*end == '\0') {
+      break;
+    }
+    if (*end != ',') {
+      error = "Invalid trigger value in " + spec;
+      return false;
+    }
+    cursor = end + 1;
+  }
+
+  using Type = Condition::Type;
+  using Direction = Condition::Direction;
+  Condition result;
+  std::size_t required = 1;
+  if (kind == "below" || kind == "above") {
+    result.type = Type::Level;
+    result.direction = kind == "above" ? Direction::Rising : Direction::Falling;
+    result.level = values[0];
+  } else if (kind == "falling" || kind == "rising" || kind == "crossing") {
+    result.type = Type::Edge;
+    result.direction = kind == "rising"    ? Direction::Rising
+                       : kind == "falling" ? Direction::Falling
+                                           : Direction::Either;
+    result.level = values[0];
+  } else if (kind == "outside") {
+    required = 2;
+    if (values.size() < required || values[0] >= values[1]) {
+      error = "Window trigger needs low,high with low < high";
+      return false;
+    }
+    result.type = Type::Window;
+    result.low = values[0];
+    result.high = values[1];
+  } else if (kind == "slope" || kind == "slope+" || kind == "slope-") {
+    result.type = Type::Slope;
+    result.direction = kind == "slope+"   ? Direction::Rising
+                       : kind == "slope-" ? Direction::Falling
+                                          : Direction::Either;
+    result.perSecond = std::fabs(values[0]);
+  } else {
+    error = "Unknown trigger " + kind;
+    return false;
+  }
+
+  // One optional trailing value: the hysteresis
+  if (values.size() > required + 1 ||
+      (result.type == Type::Slope && values.size() > required)) {
+    error = "Too many trigger values in " + spec;
+    return false;
+  }
+  if (values.size() == required + 1) {
+    result.hysteresis = std::fabs(values[required]);
+  }
+  condition = result;
+  return true;
+}
+
+TriggerEngine::TriggerEngine(const Condition &condition,
+                             const std::size_t preSamples,
+                             const std::size_t postSamples)
+    : m_condition(condition), m_history(preSamples), m_post(postSamples) {}
+
+void TriggerEngine::reset() {
+  m_history_head = 0;
+  m_history_size = 0;
+  m_post_remaining = 0;
+  m_armed = true;
+  m_contiguous = true;
+  m_has_previous = false;
+}
+
+bool TriggerEngine::fires(const Reading &reading) const {
+  const double value = reading.value;
+  const double level = m_condition.level;
+  switch (m_condition.type) {
+  case Condition::Type::Level:
+    return m_condition.direction == Condition::Direction::Rising
+               ? value > level
+               : value < level;
+  case Condition::Type::Edge: {
+    if (!m_has_previous || m_previous_mode != reading.mode) {
+      return false;
+    }
+    const bool rising = m_previous_value <= level && value > level;
+    const bool falling = m_previous_value >= level && value < level;
+    switch (m_condition.direction) {
+    case Condition::Direction::Rising:
+      return rising;
+    case Condition::Direction::Falling:
+      return falling;
+    case Condition::Direction::Either:
+      return rising || falling;
+    }
+    return false;
+  }
+  case Condition::Type::Window:
+    return value < m_condition.low || value > m_condition.high;
+  case Condition::Type::Slope:
+    return slopeExceeded(reading);
+  }
+  return false;
+}
+
+bool TriggerEngine::cleared(const Reading &reading) const {
+  const double value = reading.value;
+  const double margin = m_condition.hysteresis;
+  const double level = m_condition.level;
+  switch (m_condition.type) {
+  case Condition::Type::Level:
+  case Condition::Type::Edge:
+    switch (m_condition.direction) {
+    case Condition::Direction::Rising:
+      return value <= level - margin;
+    case Condition::Direction::Falling:
+      return value >= level + margin;
+    case Condition::Direction::Either:
+      return std::fabs(value - level) >= margin;
+    }
+    return true;
+  case Condition::Type::Window:
+    return value >= m_condition.low + margin &&
+           value <= m_condition.high - margin;
+  case Condition::Type::Slope:
+    return !slopeExceeded(reading);
+  }
+  return true;
+}
+
+bool TriggerEngine::slopeExceeded(const Reading &reading) const {
+  if (!m_has_previous || m_previous_mode != reading.mode ||
+      reading.timestampNs <= m_previous_ns) {
+    return false;
+  }
+  const double perSecond = (reading.value - m_previous_value) * 1e9 /
+                           static_cast<double>(reading.timestampNs -
+                                               m_previous_ns);
+  switch (m_condition.direction) {
+  case Condition::Direction::Rising:
+    return perSecond >= m_condition.perSecond;
+  case Condition::Direction::Falling:
+    return perSecond <= -m_condition.perSecond;
+  case Condition::Direction::Either:
+    return std::fabs(perSecond) >= m_condition.perSecond;
+  }
+  return false;
+}
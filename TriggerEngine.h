@@ -0,0 +1,142 @@
+#ifndef TRIGGERENGINE_H
+#define TRIGGERENGINE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Reading.h"
+#include "RecordingFormat.h"
+
+// Watches a stream of readings for a condition and picks out the samples
+// around each event: the last preSamples before it, the one that fired and
+// the postSamples after it. Everything else is discarded. History is a fixed
+// ring allocated in the constructor, so memory use does not grow however
+// long it runs, and checking a sample is a few comparisons.
+//
+// After a capture the engine re-arms only once the condition has cleared
+// (by the hysteresis margin, if any), so a level that stays low gives one
+// capture rather than one after another.
+class TriggerEngine {
+public:
+  struct Condition {
+    enum class Type : std::uint8_t {
+      Level,  // value beyond level
+      Edge,   // value crosses level
+      Window, // value leaves [low, high]
+      Slope,  // |dv/dt| at least perSecond
+    };
+    enum class Direction : std::uint8_t { Rising, Falling, Either };
+
+    Type type = Type::Level;
+    Direction direction = Direction::Falling;
+    double level = 0;
+    double low = 0;
+    double high = 0;
+    double perSecond = 0;
+    double hysteresis = 0;
+  };
+
+  // below:4.75[,hyst]  above:5.25[,hyst]      level
+  // falling:4.75[,hyst]  rising:..  crossing:..  edge
+  // outside:4.5,5.5[,hyst]                    window
+  // slope:10  slope+:10  slope-:10            units per second
+  static bool parse(const std::string &spec, Condition &condition,
+                    std::string &error);
+
+  TriggerEngine(const Condition &condition, std::size_t preSamples,
+                std::size_t postSamples);
+
+  // Calls save(reading, flags) for every sample that belongs to a capture,
+  // in order. The first sample of a capture that does not directly follow
+  // the previous one carries RecordingRecord::Gap, the sample that fired
+  // RecordingRecord::Trigger.
+  template <typename Save> void feed(const Reading &reading, Save &&save) {
+    if (m_post_remaining > 0) {
+      --m_post_remaining;
+      if (!reading.overload) {
+        remember(reading);
+      }
+      save(reading, std::uint16_t{0});
+      return;
+    }
+    bool fire = false;
+    if (!reading.overload) {
+      if (m_armed) {
+        fire = fires(reading);
+      } else if (cleared(reading)) {
+        m_armed = true;
+      }
+      remember(reading);
+    }
+    if (!fire) {
+      keep(reading);
+      return;
+    }
+
+    ++m_triggers;
+    m_armed = false;
+    std::uint16_t flags = m_contiguous ? 0 : RecordingRecord::Gap;
+    for (std::size_t i = 0; i < m_history_size; ++i) {
+      save(m_history[(m_history_head + i) % m_history.size()], flags);
+      flags = 0;
+    }
+    m_history_size = 0;
+    save(reading, static_cast<std::uint16_t>(flags | RecordingRecord::Trigger));
+    m_post_remaining = m_post;
+    m_contiguous = true;
+  }
+
+  // Forget history and re-arm, e.g. when a recording starts
+  void reset();
+
+  [[nodiscard]] std::uint64_t triggers() const { return m_triggers; }
+
+private:
+  Condition m_condition;
+  std::vector<Reading> m_history;
+  std::size_t m_history_head = 0;
+  std::size_t m_history_size = 0;
+  std::size_t m_post;
+  std::size_t m_post_remaining = 0;
+  bool m_armed = true;
+  // Nothing was dropped since the last saved sample (or the start)
+  bool m_contiguous = true;
+  bool m_has_previous = false;
+  double m_previous_value = 0;
+  std::int64_t m_previous_ns = 0;
+  MeasurementMode m_previous_mode = MeasurementMode::Unknown;
+  std::uint64_t m_triggers = 0;
+
+  [[nodiscard]] bool fires(const Reading &reading) const;
+
+  // The condition is false, with the hysteresis margin to spare
+  [[nodiscard]] bool cleared(const Reading &reading) const;
+
+  [[nodiscard]] bool slopeExceeded(const Reading &reading) const;
+
+  void remember(const Reading &reading) {
+    m_has_previous = true;
+    m_previous_value = reading.value;
+    m_previous_ns = reading.timestampNs;
+    m_previous_mode = reading.mode;
+  }
+
+  // Pre-trigger history; the oldest sample falls out when it is full
+  void keep(const Reading &reading) {
+    if (m_history.empty()) {
+      m_contiguous = false;
+      return;
+    }
+    if (m_history_size == m_history.size()) {
+      m_history_head = (m_history_head + 1) % m_history.size();
+      --m_history_size;
+      m_contiguous = false;
+    }
+    m_history[(m_history_head + m_history_size) % m_history.size()] = reading;
+    ++m_history_size;
+  }
+};
+
+#endif // TRIGGERENGINE_H
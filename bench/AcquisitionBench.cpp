@@ -0,0 +1,394 @@
+// End-to-end acquisition benchmark. Measures the line framer, the decoder,
+// the trigger check and a full query/response round trip through
+// ScpiCommandQueue against a SimulatedMeter on a pseudo-terminal, and prints
+// one JSON object:
+//
+//   {"framer": {...}, "decoder": {...}, "trigger": {...},
+//    "round_trip": {...}}
+//
+// Each stage reports samples, samples_per_second, latency_ns (p50, p99,
+// p99_9, max), cpu_ns_per_sample and allocations_per_sample. CPU time and
+// allocations are counted for the benchmark thread only, so the simulator
+// thread standing in for the meter does not show up in the figures.
+//
+//   acquisition_bench [--samples n] [--round-trips n] [--delay-ms ms]
+//                     [--out file]
+#include "ScpiCommandQueue.h"
+#include "ScpiDecoder.h"
+#include "ScpiLineFramer.h"
+#include "SimulatedMeter.h"
+#include "TriggerEngine.h"
+
+#include <QCoreApplication>
+#include <QSerialPort>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <functional>
+#include <iterator>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef __unix__
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+#endif
+
+// Every allocation on the benchmark thread goes through here
+static thread_local std::uint64_t t_allocations = 0;
+
+void *operator new(std::size_t size) {
+  ++t_allocations;
+  if (void *p = std::malloc(size ? size : 1)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+
+static std::int64_t nowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+static std::int64_t threadCpuNs() {
+#ifdef CLOCK_THREAD_CPUTIME_ID
+  timespec ts{};
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return static_cast<std::int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+#else
+  return static_cast<std::int64_t>(std::clock()) * 1000000000 /
+         CLOCKS_PER_SEC;
+#endif
+}
+
+// Wall time, CPU time and allocations between start() and stop(), plus one
+// latency per sample
+class Stage {
+public:
+  explicit Stage(const std::size_t expected) { m_latencies.reserve(expected); }
+
+  void start() {
+    m_wall_ns = nowNs();
+    m_cpu_ns = threadCpuNs();
+    m_allocations = t_allocations;
+  }
+
+  void stop() {
+    m_wall_ns = nowNs() - m_wall_ns;
+    m_cpu_ns = threadCpuNs() - m_cpu_ns;
+    m_allocations = t_allocations - m_allocations;
+  }
+
+  // Reserved up front so recording does not count as an allocation
+  void add(const std::int64_t latencyNs) {
+    if (m_latencies.size() < m_latencies.capacity()) {
+      m_latencies.push_back(latencyNs);
+    }
+  }
+
+  void addSamples(const std::uint64_t count) { m_samples += count; }
+
+  [[nodiscard]] std::string json() {
+    std::sort(m_latencies.begin(), m_latencies.end());
+    const auto percentile = [this](const double p) -> std::int64_t {
+      if (m_latencies.empty()) {
+        return 0;
+      }
+      const auto index = static_cast<std::size_t>(
+          p * static_cast<double>(m_latencies.size() - 1) + 0.5);
+      return m_latencies[index];
+    };
+    const double samples = m_samples ? static_cast<double>(m_samples) : 1.0;
+    char buffer[512];
+    std::snprintf(
+        buffer, sizeof(buffer),
+        "{\"samples\": %llu, \"samples_per_second\": %.1f, "
+        "\"latency_ns\": {\"p50\": %lld, \"p99\": %lld, \"p99_9\": %lld, "
+        "\"max\": %lld}, \"cpu_ns_per_sample\": %.1f, "
+        "\"allocations_per_sample\": %.3f}",
+        static_cast<unsigned long long>(m_samples),
+        m_wall_ns > 0 ? m_samples * 1e9 / static_cast<double>(m_wall_ns) : 0.0,
+        static_cast<long long>(percentile(0.5)),
+        static_cast<long long>(percentile(0.99)),
+        static_cast<long long>(percentile(0.999)),
+        static_cast<long long>(m_latencies.empty() ? 0 : m_latencies.back()),
+        static_cast<double>(m_cpu_ns) / samples,
+        static_cast<double>(m_allocations) / samples);
+    return buffer;
+  }
+
+private:
+  std::vector<std::int64_t> m_latencies;
+  std::uint64_t m_samples = 0;
+  std::int64_t m_wall_ns = 0;
+  std::int64_t m_cpu_ns = 0;
+  std::uint64_t m_allocations = 0;
+};
+
+// What a busy meter sends back: MEAS1? answers with some display strings
+// mixed in
+static std::string responseStream(const std::size_t lines) {
+  SimulatedMeter::Options options;
+  options.noise = 0.01;
+  options.overloadProbability = 0.001;
+  SimulatedMeter meter(options);
+  std::string stream;
+  for (std::size_t i = 0; i < lines; ++i) {
+    const auto t = static_cast<std::int64_t>(i) * meter.updatePeriodNs();
+    stream += i % 8 == 7 ? meter.execute("MEAS1:SHOW?", t)
+                         : meter.execute("MEAS1?", t);
+    stream += "\r\n";
+  }
+  return stream;
+}
+
+static std::string benchFramer(const std::string &stream,
+                               const std::size_t lines) {
+  ScpiLineFramer framer;
+  Stage stage(lines);
+  std::uint64_t seen = 0;
+  // Serial reads come in odd sizes; cycle through a few
+  static constexpr std::size_t kChunks[] = {1, 7, 13, 32, 64, 5, 17};
+  std::size_t offset = 0;
+  std::size_t chunk = 0;
+  stage.start();
+  while (offset < stream.size()) {
+    const std::size_t size =
+        std::min(kChunks[chunk++ % std::size(kChunks)], stream.size() - offset);
+    const std::uint64_t before = seen;
+    const std::int64_t begin = nowNs();
+    framer.append(stream.data() + offset, static_cast<qsizetype>(size),
+                  [&seen](const QByteArray &) { ++seen; });
+    const std::int64_t elapsed = nowNs() - begin;
+    // A line's latency is the call that delivered its last byte
+    for (std::uint64_t i = before; i < seen; ++i) {
+      stage.add(elapsed);
+    }
+    offset += size;
+  }
+  stage.stop();
+  stage.addSamples(seen);
+  return stage.json();
+}
+
+static std::string benchDecoder(const std::string &stream,
+                                const std::size_t lines) {
+  // Split up front so only the decoder is timed
+  std::vector<std::pair<std::size_t, std::size_t>> spans;
+  spans.reserve(lines);
+  for (std::size_t start = 0; start < stream.size();) {
+    const std::size_t end = stream.find("\r\n", start);
+    spans.emplace_back(start, end - start);
+    start = end + 2;
+  }
+  Stage stage(spans.size());
+  volatile double sink = 0;
+  stage.start();
+  for (const auto &[start, length] : spans) {
+    const std::int64_t begin = nowNs();
+    sink = sink + ScpiDecoder::decode(stream.data() + start, length).value;
+    stage.add(nowNs() - begin);
+  }
+  stage.stop();
+  stage.addSamples(spans.size());
+  return stage.json();
+}
+
+// Checking every sample of a noisy 5 V rail for a dip below 4.75 V
+static std::string benchTrigger(const std::size_t samples) {
+  SimulatedMeter::Options options;
+  options.noise = 0.02; // about 0.1 V around 5 V
+  SimulatedMeter meter(options);
+  std::vector<Reading> readings(samples);
+  for (std::size_t i = 0; i < samples; ++i) {
+    const auto t = static_cast<std::int64_t>(i) * meter.updatePeriodNs();
+    readings[i].timestampNs = t;
+    readings[i].mode = MeasurementMode::VoltageDC;
+    readings[i].value = meter.value(t);
+  }
+  TriggerEngine::Condition condition;
+  condition.level = 4.75;
+  condition.hysteresis = 0.05;
+  TriggerEngine engine(condition, 1000, 1000);
+
+  Stage stage(samples);
+  std::uint64_t saved = 0;
+  stage.start();
+  for (const Reading &reading : readings) {
+    const std::int64_t begin = nowNs();
+    engine.feed(reading, [&saved](const Reading &, std::uint16_t) { ++saved; });
+    stage.add(nowNs() - begin);
+  }
+  stage.stop();
+  stage.addSamples(samples);
+  std::fprintf(stderr, "trigger: %llu events, %llu samples kept\n",
+               static_cast<unsigned long long>(engine.triggers()),
+               static_cast<unsigned long long>(saved));
+  return stage.json();
+}
+
+#ifdef __unix__
+// The meter's side of the pty, on its own thread
+static void serveMeter(const int master, const SimulatedMeter::Options options,
+                       std::atomic<bool> &stop) {
+  SimulatedMeter meter(options);
+  char buffer[512];
+  std::string response;
+  while (!stop) {
+    pollfd fd{master, POLLIN, 0};
+    if (poll(&fd, 1, 50) <= 0) {
+      continue;
+    }
+    const ssize_t count = read(master, buffer, sizeof(buffer));
+    if (count <= 0) {
+      continue;
+    }
+    response.clear();
+    meter.receive(buffer, static_cast<std::size_t>(count), nowNs(), response);
+    if (response.empty()) {
+      continue;
+    }
+    const std::int64_t delay = meter.responseDelayNs();
+    if (delay > 0) {
+      std::this_thread::sleep_for(std::chrono::nanoseconds(delay));
+    }
+    if (write(master, response.data(), response.size()) < 0) {
+      std::perror("write");
+    }
+  }
+}
+
+static std::string benchRoundTrip(const std::size_t roundTrips,
+                                  const double delayMs) {
+  const int master = posix_openpt(O_RDWR | O_NOCTTY);
+  if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0) {
+    std::perror("posix_openpt");
+    return "null";
+  }
+  const QString slaveName = QString::fromLocal8Bit(ptsname(master));
+  // Raw mode before anyone opens it, so the line discipline never echoes
+  if (const int slave = open(ptsname(master), O_RDWR | O_NOCTTY);
+      slave >= 0) {
+    termios tio{};
+    tcgetattr(slave, &tio);
+    cfmakeraw(&tio);
+    tcsetattr(slave, TCSANOW, &tio);
+    close(slave);
+  }
+
+  SimulatedMeter::Options options;
+  options.delayNs = static_cast<std::int64_t>(delayMs * 1e6);
+  options.jitterNs = 0;
+  std::atomic<bool> stop{false};
+  std::thread meter(serveMeter, master, options, std::ref(stop));
+
+  QSerialPort port;
+  port.setPortName(slaveName);
+  port.setBaudRate(QSerialPort::Baud115200);
+  if (!port.open(QIODevice::ReadWrite)) {
+    std::fprintf(stderr, "Could not open %s\n", ptsname(master));
+    stop = true;
+    meter.join();
+    close(master);
+    return "null";
+  }
+  ScpiCommandQueue queue;
+  queue.attach(&port);
+
+  Stage stage(roundTrips);
+  std::uint64_t done = 0;
+  std::uint64_t failed = 0;
+  std::int64_t sent = 0;
+  // Same shape as the worker's poll loop: one MEAS1? in flight at a time
+  std::function<void()> next = [&] {
+    if (done + failed >= roundTrips) {
+      QCoreApplication::quit();
+      return;
+    }
+    sent = nowNs();
+    queue.query("MEAS1?", [&](const bool ok, const QByteArray &line) {
+      if (ok && ScpiDecoder::decode(line.constData(), line.size()).ok) {
+        stage.add(nowNs() - sent);
+        ++done;
+      } else {
+        ++failed;
+      }
+      next();
+    });
+  };
+  // Warm up the port and the queue before measuring
+  queue.query("*IDN?", [&](bool, const QByteArray &) {
+    stage.start();
+    next();
+  });
+  QCoreApplication::exec();
+  stage.stop();
+  stage.addSamples(done);
+
+  queue.detach();
+  port.close();
+  stop = true;
+  meter.join();
+  close(master);
+  if (failed > 0) {
+    std::fprintf(stderr, "%llu round trips failed\n",
+                 static_cast<unsigned long long>(failed));
+  }
+  return stage.json();
+}
+#endif
+
+int main(int argc, char *argv[]) {
+  QCoreApplication app(argc, argv);
+  std::size_t samples = 1000000;
+  std::size_t roundTrips = 20000;
+  double delayMs = 0;
+  const char *out = nullptr;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    const std::string arg = argv[i];
+    if (arg == "--samples") {
+      samples = std::strtoull(argv[i + 1], nullptr, 10);
+    } else if (arg == "--round-trips") {
+      roundTrips = std::strtoull(argv[i + 1], nullptr, 10);
+    } else if (arg == "--delay-ms") {
+      delayMs = std::atof(argv[i + 1]);
+    } else if (arg == "--out") {
+      out = argv[i + 1];
+    } else {
+      std::fprintf(stderr, "Unknown option %s\n", argv[i]);
+      return 1;
+    }
+  }
+
+  const std::string stream = responseStream(samples);
+  std::string json = "{\"framer\": " + benchFramer(stream, samples) +
+                     ", \"decoder\": " + benchDecoder(stream, samples) +
+                     ", \"trigger\": " + benchTrigger(samples);
+#ifdef __unix__
+  json += ", \"round_trip\": " + benchRoundTrip(roundTrips, delayMs);
+#endif
+  json += "}\n";
+
+  FILE *file = out ? std::fopen(out, "w") : stdout;
+  if (!file) {
+    std::perror(out);
+    return 1;
+  }
+  std::fputs(json.c_str(), file);
+  if (out) {
+    std::fclose(file);
+  }
+  return 0;
+}
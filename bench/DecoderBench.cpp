@@ -0,0 +1,72 @@
+// Compares the table-driven ScpiDecoder with the QByteArray/QRegularExpression
+// fix-up the worker used to run on every MEAS1:SHOW? response.
+#include "ScpiDecoder.h"
+
+#include <QByteArray>
+#include <QRegularExpression>
+#include <QString>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+static QString legacyDecode(QByteArray data) {
+  if (data.contains(QByteArray("\xa6\xb8", 2))) {
+    data.replace(QByteArray("\xa6\xb8", 2), "Ω");
+  }
+  if (data.contains(QByteArray("\xa6\xcc", 2))) {
+    data.replace(QByteArray("\xa6\xcc", 2), "µ");
+  }
+  if (data.contains(QByteArray("\xa1\xe6", 2))) {
+    data.replace(QByteArray("\xa1\xe6", 2), "°C");
+  }
+  if (data.contains(QByteArray("\xa8\x48", 2))) {
+    data.replace(QByteArray("\xa8\x48", 2), "°F");
+  }
+  QString response = QString::fromUtf8(data);
+  QRegularExpression re("([-+]?[0-9]*\\.?[0-9]+)([^0-9.]+)");
+  response = response.replace(re, "\\1 \\2");
+  response = response.replace("  ", " ");
+  return response;
+}
+
+int main() {
+  const std::vector<QByteArray> lines = {
+      "12.345mV",        "-0.0012V",        "1.2345k\xa6\xb8",
+      "49.998M\xa6\xb8", "4.7012\xa6\xcc" "F", "25.31\xa1\xe6",
+      "77.56\xa8\x48",   "1.0002kHz",       "1.2345E-03",
+      "OL",
+  };
+  constexpr int kRounds = 200000;
+  const auto count = static_cast<double>(kRounds) * lines.size();
+
+  volatile double sink = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < kRounds; ++i) {
+    for (const auto &line : lines) {
+      sink = sink + ScpiDecoder::decode(line.constData(), line.size()).value;
+    }
+  }
+  const double decoderNs =
+      std::chrono::duration<double, std::nano>(
+          std::chrono::steady_clock::now() - start)
+          .count() /
+      count;
+
+  qsizetype legacyLength = 0;
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < kRounds / 100; ++i) {
+    for (const auto &line : lines) {
+      legacyLength += legacyDecode(line).size();
+    }
+  }
+  const double legacyNs =
+      std::chrono::duration<double, std::nano>(
+          std::chrono::steady_clock::now() - start)
+          .count() /
+      (count / 100);
+
+  std::printf("ScpiDecoder::decode  %10.1f ns/line\n", decoderNs);
+  std::printf("legacy fix-up        %10.1f ns/line\n", legacyNs);
+  std::printf("speedup              %10.1fx\n", legacyNs / decoderNs);
+  return legacyLength > 0 ? 0 : 1;
+}
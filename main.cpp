@@ -1,8 +1,39 @@
+#include "HeadlessRunner.h"
 #include "MainWindow.h"
 #include <QApplication>
+#include <QCoreApplication>
 #include <QPushButton>
+#include <cstring>
+#include <iostream>
+
+static bool wantsHeadless(int argc, char *argv[]) {
+  for (int i = 1; i < argc; ++i) {
+    if (std::strcmp(argv[i], "--headless") == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static int runHeadless(int argc, char *argv[]) {
+  // No QApplication here, so this works without a display server
+  QCoreApplication a(argc, argv);
+  HeadlessRunner::Options options;
+  QString error;
+  if (!HeadlessRunner::parseArguments(QCoreApplication::arguments(), options,
+                                      error)) {
+    std::cerr << error.toStdString() << std::endl;
+    return 1;
+  }
+  HeadlessRunner runner(options);
+  runner.start();
+  return QCoreApplication::exec();
+}
 
 int main(int argc, char *argv[]) {
+  if (wantsHeadless(argc, argv)) {
+    return runHeadless(argc, argv);
+  }
   QApplication a(argc, argv);
   MainWindow mainWindow;
   mainWindow.show();
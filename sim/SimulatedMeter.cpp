@@ -0,0 +1,330 @@
+#include "SimulatedMeter.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+
+SimulatedMeter::SimulatedMeter(const Options &options)
+    : m_options(options), m_random(options.seed),
+      m_secondary(options.secondary) {}
+
+void SimulatedMeter::receive(const char *data, const std::size_t size,
+                             const std::int64_t nowNs, std::string &response) {
+  for (std::size_t i = 0; i < size; ++i) {
+    const char c = data[i];
+    if (c == '\n' || c == '\r') {
+      if (!m_line.empty()) {
+        const std::string answer = execute(m_line, nowNs);
+        if (!answer.empty()) {
+          response += answer;
+          response += "\r\n";
+        }
+        m_line.clear();
+      }
+    } else if (m_line.size() < 256) {
+      m_line += c;
+    }
+  }
+}
+
+std::string SimulatedMeter::execute(const std::string &command,
+                                    const std::int64_t nowNs) {
+  std::string upper = command;
+  std::transform(upper.begin(), upper.end(), upper.begin(),
+                 [](unsigned char c) { return std::toupper(c); });
+
+  if (upper == "*IDN?") {
+    return "OWON,XDM1041,SIM0000001,V4.3.0,3";
+  }
+  if (upper == "MEAS1?" || upper == "MEAS?") {
+    const double reading = value(nowNs);
+    return formatScientific(reading, m_sample_overload);
+  }
+  if (upper == "MEAS1:SHOW?" || upper == "MEAS:SHOW?") {
+    const double reading = value(nowNs);
+    return formatShow(reading, m_mode, m_sample_overload);
+  }
+  if (upper == "FUNC?" || upper == "FUNC1?") {
+    return std::string("\"") + functionName(m_mode) + "\"";
+  }
+  // Without a secondary function these go unanswered
+  if ((upper == "MEAS2?" || upper == "MEAS2:SHOW?") &&
+      m_secondary != MeasurementMode::Unknown) {
+    const double reading = nominal(m_secondary);
+    return upper == "MEAS2?" ? formatScientific(reading, false)
+                             : formatShow(reading, m_secondary, false);
+  }
+  if (upper == "FUNC2?") {
+    return m_secondary == MeasurementMode::Unknown
+               ? "\"NONe\""
+               : std::string("\"") + functionName(m_secondary) + "\"";
+  }
+  if (upper.rfind("FUNC2 ", 0) == 0) {
+    std::string name = upper.substr(6);
+    name.erase(std::remove(name.begin(), name.end(), '"'), name.end());
+    m_secondary = functionFromName(name);
+    return {};
+  }
+  if (upper == "RATE?") {
+    return std::string(1, m_rate);
+  }
+  if (upper == "SYST:BEEP:STAT?") {
+    return m_beep ? "ON" : "OFF";
+  }
+  if (upper == "CONT:THRE?") {
+    return std::to_string(m_threshold);
+  }
+  if (upper == "RANGE?") {
+    return m_range;
+  }
+  if (upper.rfind("RATE ", 0) == 0 && upper.size() > 5) {
+    const char rate = upper[5];
+    if (rate == 'S' || rate == 'M' || rate == 'F') {
+      m_rate = rate;
+      m_sample_tick = -1;
+    }
+    return {};
+  }
+  if (upper.rfind("SYST:BEEP:STAT ", 0) == 0) {
+    m_beep = upper.compare(15, std::string::npos, "ON") == 0;
+    return {};
+  }
+  if (upper.rfind("CONT:THRE ", 0) == 0) {
+    m_threshold = std::atoi(upper.c_str() + 10);
+    return {};
+  }
+  if (upper.rfind("CONF:", 0) == 0) {
+    configure(upper);
+    return {};
+  }
+  // The meter silently ignores anything it does not understand
+  return {};
+}
+
+bool SimulatedMeter::configure(const std::string &command) {
+  static const struct {
+    const char *prefix;
+    MeasurementMode mode;
+  } functions[] = {
+      {"CONF:VOLT:DC", MeasurementMode::VoltageDC},
+      {"CONF:VOLT:AC", MeasurementMode::VoltageAC},
+      {"CONF:CURR:DC", MeasurementMode::CurrentDC},
+      {"CONF:CURR:AC", MeasurementMode::CurrentAC},
+      {"CONF:RES", MeasurementMode::Resistance},
+      {"CONF:CONT", MeasurementMode::Continuity},
+      {"CONF:DIOD", MeasurementMode::Diode},
+      {"CONF:CAP", MeasurementMode::Capacitance},
+      {"CONF:FREQ", MeasurementMode::Frequency},
+      {"CONF:PER", MeasurementMode::Period},
+      {"CONF:TEMP", MeasurementMode::Temperature},
+  };
+  for (const auto &function : functions) {
+    const std::string prefix = function.prefix;
+    if (command.rfind(prefix, 0) != 0) {
+      continue;
+    }
+    m_mode = function.mode;
+    const std::size_t space = command.find(' ', prefix.size());
+    m_range = space == std::string::npos ? "AUTO" : command.substr(space + 1);
+    m_sample_tick = -1;
+    return true;
+  }
+  return false;
+}
+
+std::int64_t SimulatedMeter::responseDelayNs() {
+  if (m_options.jitterNs <= 0) {
+    return m_options.delayNs;
+  }
+  std::uniform_int_distribution<std::int64_t> jitter(0, m_options.jitterNs);
+  return m_options.delayNs + jitter(m_random);
+}
+
+void SimulatedMeter::corrupt(std::string &bytes) {
+  if (m_options.dropProbability <= 0) {
+    return;
+  }
+  std::bernoulli_distribution drop(m_options.dropProbability);
+  bytes.erase(std::remove_if(bytes.begin(), bytes.end(),
+                             [&](char) { return drop(m_random); }),
+              bytes.end());
+}
+
+double SimulatedMeter::value(const std::int64_t nowNs) {
+  const std::int64_t tick = nowNs / updatePeriodNs();
+  if (tick != m_sample_tick) {
+    m_sample_tick = tick;
+    const double center = nominal(m_mode);
+    std::normal_distribution<double> noise(
+        0.0, std::abs(center) * m_options.noise);
+    m_sample_value = m_options.noise > 0 ? center + noise(m_random) : center;
+    m_sample_overload =
+        m_options.overloadProbability > 0 &&
+        std::bernoulli_distribution(m_options.overloadProbability)(m_random);
+  }
+  return m_sample_value;
+}
+
+std::int64_t SimulatedMeter::updatePeriodNs() const {
+  // Capacitance and frequency take longer per conversion on the real meter
+  std::int64_t period;
+  switch (m_rate) {
+  case 'S':
+    period = 500000000;
+    break;
+  case 'M':
+    period = 200000000;
+    break;
+  default:
+    period = 50000000;
+    break;
+  }
+  if (m_mode == MeasurementMode::Capacitance) {
+    period = std::max<std::int64_t>(period, 500000000);
+  } else if (m_mode == MeasurementMode::Frequency ||
+             m_mode == MeasurementMode::Period) {
+    period = std::max<std::int64_t>(period, 200000000);
+  }
+  return period;
+}
+
+std::string SimulatedMeter::formatScientific(const double value,
+                                             const bool overload) {
+  if (overload) {
+    return "1E+9";
+  }
+  char buffer[32];
+  std::snprintf(buffer, sizeof(buffer), "%.6E", value);
+  return buffer;
+}
+
+std::string SimulatedMeter::formatShow(double value, const MeasurementMode mode,
+                                       const bool overload) {
+  if (overload) {
+    return "OL";
+  }
+  std::string unit;
+  switch (unitForMode(mode)) {
+  case Unit::Volt:
+    unit = "V";
+    break;
+  case Unit::Ampere:
+    unit = "A";
+    break;
+  case Unit::Ohm:
+    unit = "\xa6\xb8";
+    break;
+  case Unit::Farad:
+    unit = "F";
+    break;
+  case Unit::Hertz:
+    unit = "Hz";
+    break;
+  case Unit::Second:
+    unit = "s";
+    break;
+  case Unit::Celsius:
+    unit = "\xa1\xe6";
+    break;
+  default:
+    break;
+  }
+
+  const char *prefix = "";
+  if (mode != MeasurementMode::Temperature && value != 0.0) {
+    static const struct {
+      double scale;
+      const char *prefix;
+    } prefixes[] = {
+        {1e6, "M"},  {1e3, "k"},         {1.0, ""},
+        {1e-3, "m"}, {1e-6, "\xa6\xcc"}, {1e-9, "n"},
+    };
+    for (const auto &candidate : prefixes) {
+      if (std::abs(value) >= candidate.scale) {
+        value /= candidate.scale;
+        prefix = candidate.prefix;
+        break;
+      }
+    }
+  }
+  // Five significant digits, as on the display
+  const double magnitude = std::abs(value);
+  const int decimals = magnitude >= 100 ? 2 : magnitude >= 10 ? 3 : 4;
+  char buffer[32];
+  std::snprintf(buffer, sizeof(buffer), "%.*f", decimals, value);
+  return buffer + std::string(prefix) + unit;
+}
+
+double SimulatedMeter::nominal(const MeasurementMode mode) {
+  switch (mode) {
+  case MeasurementMode::VoltageDC:
+    return 5.0012;
+  case MeasurementMode::VoltageAC:
+    return 229.87;
+  case MeasurementMode::CurrentDC:
+    return 0.10234;
+  case MeasurementMode::CurrentAC:
+    return 0.5012;
+  case MeasurementMode::Resistance:
+    return 4701.2;
+  case MeasurementMode::Continuity:
+    return 0.51;
+  case MeasurementMode::Diode:
+    return 0.6123;
+  case MeasurementMode::Capacitance:
+    return 4.7012e-6;
+  case MeasurementMode::Frequency:
+    return 1000.2;
+  case MeasurementMode::Period:
+    return 0.00099980;
+  case MeasurementMode::Temperature:
+    return 25.31;
+  case MeasurementMode::Unknown:
+    break;
+  }
+  return 0.0;
+}
+
+MeasurementMode SimulatedMeter::functionFromName(const std::string &name) {
+  std::string upper = name;
+  std::transform(upper.begin(), upper.end(), upper.begin(),
+                 [](unsigned char c) { return std::toupper(c); });
+  for (int i = 1; i <= static_cast<int>(MeasurementMode::Temperature); ++i) {
+    const auto mode = static_cast<MeasurementMode>(i);
+    if (upper == functionName(mode)) {
+      return mode;
+    }
+  }
+  return MeasurementMode::Unknown;
+}
+
+const char *SimulatedMeter::functionName(const MeasurementMode mode) {
+  switch (mode) {
+  case MeasurementMode::VoltageDC:
+    return "VOLT";
+  case MeasurementMode::VoltageAC:
+    return "VOLT AC";
+  case MeasurementMode::CurrentDC:
+    return "CURR";
+  case MeasurementMode::CurrentAC:
+    return "CURR AC";
+  case MeasurementMode::Resistance:
+    return "RES";
+  case MeasurementMode::Continuity:
+    return "CONT";
+  case MeasurementMode::Diode:
+    return "DIOD";
+  case MeasurementMode::Capacitance:
+    return "CAP";
+  case MeasurementMode::Frequency:
+    return "FREQ";
+  case MeasurementMode::Period:
+    return "PER";
+  case MeasurementMode::Temperature:
+    return "TEMP";
+  case MeasurementMode::Unknown:
+    break;
+  }
+  return "";
+}
@@ -0,0 +1,87 @@
+#ifndef SIMULATEDMETER_H
+#define SIMULATEDMETER_H
+
+#include <cstdint>
+#include <random>
+#include <string>
+
+#include "Reading.h"
+
+// Behaves like an XDM1041 at the SCPI level, minus the serial port: feed it
+// the bytes the host sent and it returns what the meter would answer. The
+// pty simulator wraps it, and so can anything else that needs a meter
+// without hardware. Qt-free on purpose.
+class SimulatedMeter {
+public:
+  struct Options {
+    // Standard deviation of the reading, relative to the nominal value
+    double noise = 0.0005;
+    // Time between receiving a query and starting to answer it
+    std::int64_t delayNs = 2000000;
+    // Uniformly distributed extra delay on top of delayNs
+    std::int64_t jitterNs = 500000;
+    // Probability of losing each byte of a response
+    double dropProbability = 0.0;
+    // Probability that a reading comes back as overload
+    double overloadProbability = 0.0;
+    unsigned seed = 1;
+    // Function on the secondary display (FUNC2), Unknown for none
+    MeasurementMode secondary = MeasurementMode::Unknown;
+  };
+
+  explicit SimulatedMeter(const Options &options);
+
+  // Splits the host's bytes into lines and appends the answer to each
+  // complete query to response. Statements produce nothing, like the meter.
+  void receive(const char *data, std::size_t size, std::int64_t nowNs,
+               std::string &response);
+
+  // One command line without its terminator
+  std::string execute(const std::string &command, std::int64_t nowNs);
+
+  // How long to wait before sending a response
+  std::int64_t responseDelayNs();
+
+  // Drops bytes according to Options::dropProbability
+  void corrupt(std::string &bytes);
+
+  // The meter only takes a new sample once per update period; queries in
+  // between see the same value
+  [[nodiscard]] double value(std::int64_t nowNs);
+
+  [[nodiscard]] std::int64_t updatePeriodNs() const;
+
+  [[nodiscard]] MeasurementMode mode() const { return m_mode; }
+
+  // Value as printed on the meter's display (MEAS1:SHOW?), GBK units
+  static std::string formatShow(double value, MeasurementMode mode,
+                                bool overload);
+
+  // Value as returned by MEAS1?
+  static std::string formatScientific(double value, bool overload);
+
+  // "FREQ", "VOLT AC", ... as used by FUNC?; Unknown if not a function name
+  static MeasurementMode functionFromName(const std::string &name);
+
+private:
+  Options m_options;
+  std::mt19937_64 m_random;
+  std::string m_line;
+  MeasurementMode m_mode = MeasurementMode::VoltageDC;
+  MeasurementMode m_secondary;
+  std::string m_range = "AUTO";
+  char m_rate = 'F';
+  bool m_beep = true;
+  int m_threshold = 50;
+  std::int64_t m_sample_tick = -1;
+  double m_sample_value = 0.0;
+  bool m_sample_overload = false;
+
+  bool configure(const std::string &command);
+
+  static double nominal(MeasurementMode mode);
+
+  static const char *functionName(MeasurementMode mode);
+};
+
+#endif // SIMULATEDMETER_H
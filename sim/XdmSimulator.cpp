@@ -0,0 +1,182 @@
+// Pretends to be an XDM1041 on a pseudo-terminal, so the app, the headless
+// mode and the benchmarks can run without a meter:
+//
+//   xdm_simulator --link /tmp/ttyXDM &
+//   Owon1041 --headless --port /tmp/ttyXDM
+//
+// Options: --noise <relative sigma>, --delay-ms <ms>, --jitter-ms <ms>,
+// --drop <byte loss probability>, --overload <probability>, --seed <n>,
+// --link <path> (symlink to the pty), --secondary <function> (e.g. FREQ,
+// what MEAS2 reports), --baud-delay (add the transfer time of each byte at
+// 115200 baud).
+#include "SimulatedMeter.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fcntl.h>
+#include <poll.h>
+#include <string>
+#include <termios.h>
+#include <unistd.h>
+
+static volatile std::sig_atomic_t s_stop = 0;
+
+static void onSignal(int) { s_stop = 1; }
+
+static std::int64_t nowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+static void usage(const char *argv0) {
+  std::fprintf(stderr,
+               "usage: %s [--noise s] [--delay-ms ms] [--jitter-ms ms] "
+               "[--drop p] [--overload p] [--seed n] [--link path] "
+               "[--secondary function] [--baud-delay]\n",
+               argv0);
+}
+
+int main(int argc, char *argv[]) {
+  SimulatedMeter::Options options;
+  const char *link = nullptr;
+  bool baudDelay = false;
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+    if (arg == "--baud-delay") {
+      baudDelay = true;
+      continue;
+    }
+    if (!value) {
+      usage(argv[0]);
+      return 1;
+    }
+    if (arg == "--noise") {
+      options.noise = std::atof(value);
+    } else if (arg == "--delay-ms") {
+      options.delayNs = static_cast<std::int64_t>(std::atof(value) * 1e6);
+    } else if (arg == "--jitter-ms") {
+      options.jitterNs = static_cast<std::int64_t>(std::atof(value) * 1e6);
+    } else if (arg == "--drop") {
+      options.dropProbability = std::atof(value);
+    } else if (arg == "--overload") {
+      options.overloadProbability = std::atof(value);
+    } else if (arg == "--seed") {
+      options.seed = static_cast<unsigned>(std::atoi(value));
+    } else if (arg == "--link") {
+      link = value;
+    } else if (arg == "--secondary") {
+      options.secondary = SimulatedMeter::functionFromName(value);
+      if (options.secondary == MeasurementMode::Unknown) {
+        usage(argv[0]);
+        return 1;
+      }
+    } else {
+      usage(argv[0]);
+      return 1;
+    }
+    ++i;
+  }
+
+  const int master = posix_openpt(O_RDWR | O_NOCTTY);
+  if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0) {
+    std::perror("posix_openpt");
+    return 1;
+  }
+  const char *slaveName = ptsname(master);
+  // Keep our own handle on the slave side: the line stays up between client
+  // connections instead of the master reading EIO after each close
+  const int slave = open(slaveName, O_RDWR | O_NOCTTY);
+  if (slave < 0) {
+    std::perror(slaveName);
+    return 1;
+  }
+  termios tio{};
+  tcgetattr(slave, &tio);
+  cfmakeraw(&tio);
+  cfsetispeed(&tio, B115200);
+  cfsetospeed(&tio, B115200);
+  tcsetattr(slave, TCSANOW, &tio);
+
+  if (link) {
+    unlink(link);
+    if (symlink(slaveName, link) != 0) {
+      std::perror(link);
+      return 1;
+    }
+  }
+  std::printf("%s\n", link ? link : slaveName);
+  std::fflush(stdout);
+
+  std::signal(SIGINT, onSignal);
+  std::signal(SIGTERM, onSignal);
+
+  SimulatedMeter meter(options);
+  // Responses waiting for their delay to pass, in the order they are due
+  struct Pending {
+    std::int64_t dueNs;
+    std::string bytes;
+  };
+  std::deque<Pending> pending;
+  // One bit time times ten bits per byte at 115200 baud
+  constexpr std::int64_t kByteNs = 86806;
+  char buffer[512];
+  std::string response;
+
+  while (!s_stop) {
+    int timeoutMs = 100;
+    if (!pending.empty()) {
+      const std::int64_t wait = pending.front().dueNs - nowNs();
+      timeoutMs = wait <= 0 ? 0 : static_cast<int>((wait + 999999) / 1000000);
+    }
+    pollfd fd{master, POLLIN, 0};
+    const int ready = poll(&fd, 1, timeoutMs);
+    if (ready < 0 && errno != EINTR) {
+      std::perror("poll");
+      break;
+    }
+    if (ready > 0 && (fd.revents & POLLIN)) {
+      const ssize_t count = read(master, buffer, sizeof(buffer));
+      if (count > 0) {
+        const std::int64_t received = nowNs();
+        response.clear();
+        meter.receive(buffer, static_cast<std::size_t>(count), received,
+                      response);
+        if (!response.empty()) {
+          meter.corrupt(response);
+          std::int64_t due = received + meter.responseDelayNs();
+          if (baudDelay) {
+            due += kByteNs * static_cast<std::int64_t>(response.size());
+          }
+          // A meter answers strictly in order
+          if (!pending.empty()) {
+            due = std::max(due, pending.back().dueNs);
+          }
+          pending.push_back({due, response});
+        }
+      }
+    }
+    const std::int64_t now = nowNs();
+    while (!pending.empty() && pending.front().dueNs <= now) {
+      const std::string &bytes = pending.front().bytes;
+      if (write(master, bytes.data(), bytes.size()) < 0 && errno != EAGAIN) {
+        std::perror("write");
+      }
+      pending.pop_front();
+    }
+  }
+
+  if (link) {
+    unlink(link);
+  }
+  close(slave);
+  close(master);
+  return 0;
+}
@@ -0,0 +1,194 @@
+// Byte sequences from the XDM1041 manual and what ScpiDecoder makes of them.
+// Exits non-zero if any check fails.
+#include "ScpiDecoder.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+static int failures = 0;
+
+static const char *unitName(const Unit unit) {
+  switch (unit) {
+  case Unit::None:
+    return "None";
+  case Unit::Volt:
+    return "Volt";
+  case Unit::Ampere:
+    return "Ampere";
+  case Unit::Ohm:
+    return "Ohm";
+  case Unit::Farad:
+    return "Farad";
+  case Unit::Hertz:
+    return "Hertz";
+  case Unit::Second:
+    return "Second";
+  case Unit::Celsius:
+    return "Celsius";
+  case Unit::Fahrenheit:
+    return "Fahrenheit";
+  case Unit::Kelvin:
+    return "Kelvin";
+  }
+  return "?";
+}
+
+static bool near(const double a, const double b) {
+  if (a == b) {
+    return true;
+  }
+  return std::fabs(a - b) <= 1e-12 * std::fmax(std::fabs(a), std::fabs(b));
+}
+
+static void expect(const char *label, const std::string &line,
+                   const double value, const Unit unit,
+                   const bool overload = false) {
+  const auto result = ScpiDecoder::decode(line.data(), line.size());
+  if (!result.ok || !near(result.value, value) || result.unit != unit ||
+      result.overload != overload) {
+    std::fprintf(stderr,
+                 "FAIL %s: got ok=%d value=%.12g unit=%s overload=%d, "
+                 "expected value=%.12g unit=%s overload=%d\n",
+                 label, result.ok, result.value, unitName(result.unit),
+                 result.overload, value, unitName(unit), overload);
+    ++failures;
+  }
+}
+
+static void reject(const char *label, const std::string &line) {
+  const auto result = ScpiDecoder::decode(line.data(), line.size());
+  if (result.ok) {
+    std::fprintf(stderr, "FAIL %s: accepted, value=%.12g\n", label,
+                 result.value);
+    ++failures;
+  }
+}
+
+static void testGbk() {
+  expect("GBK ohm", "1.2345k\xa6\xb8", 1234.5, Unit::Ohm);
+  expect("GBK ohm, no prefix", "220.01\xa6\xb8", 220.01, Unit::Ohm);
+  expect("GBK micro", "4.7012\xa6\xcc" "F", 4.7012e-6, Unit::Farad);
+  expect("GBK micro amps", "-12.5\xa6\xcc" "A", -12.5e-6, Unit::Ampere);
+  expect("GBK celsius", "25.31\xa1\xe6", 25.31, Unit::Celsius);
+  expect("GBK fahrenheit", "77.56\xa8\x48", 77.56, Unit::Fahrenheit);
+}
+
+static void testUtf8() {
+  expect("UTF-8 greek omega", "1.2345k\xce\xa9", 1234.5, Unit::Ohm);
+  expect("UTF-8 ohm sign", "1.2345k\xe2\x84\xa6", 1234.5, Unit::Ohm);
+  expect("UTF-8 micro sign", "4.7012\xc2\xb5" "F", 4.7012e-6, Unit::Farad);
+  expect("UTF-8 greek mu", "4.7012\xce\xbc" "F", 4.7012e-6, Unit::Farad);
+  expect("UTF-8 degree C", "25.31\xc2\xb0" "C", 25.31, Unit::Celsius);
+  expect("UTF-8 degree F", "77.56\xc2\xb0" "F", 77.56, Unit::Fahrenheit);
+  expect("UTF-8 celsius sign", "25.31\xe2\x84\x83", 25.31, Unit::Celsius);
+  expect("UTF-8 fahrenheit sign", "77.56\xe2\x84\x89", 77.56,
+         Unit::Fahrenheit);
+}
+
+static void testPrefixes() {
+  expect("pico", "12.5pF", 12.5e-12, Unit::Farad);
+  expect("nano", "470.1nF", 470.1e-9, Unit::Farad);
+  expect("micro u", "4.7uF", 4.7e-6, Unit::Farad);
+  expect("milli", "12.345mV", 12.345e-3, Unit::Volt);
+  expect("kilo", "1.0002kHz", 1000.2, Unit::Hertz);
+  expect("mega", "49.998M\xa6\xb8", 49.998e6, Unit::Ohm);
+  expect("giga", "0.5G", 0.5e9, Unit::None);
+  expect("prefix alone", "3.3m", 3.3e-3, Unit::None);
+  expect("space before unit", "12.345 mV", 12.345e-3, Unit::Volt);
+}
+
+static void testUnits() {
+  expect("volt", "-0.0012V", -0.0012, Unit::Volt);
+  expect("ampere", "1.5A", 1.5, Unit::Ampere);
+  expect("hertz upper", "50.00HZ", 50.0, Unit::Hertz);
+  expect("second", "20.00ms", 20e-3, Unit::Second);
+  expect("kelvin", "298.15K", 298.15, Unit::Kelvin);
+  expect("ohm ascii", "100.0Ohm", 100.0, Unit::Ohm);
+  expect("OHM ascii", "100.0OHM", 100.0, Unit::Ohm);
+}
+
+static void testOverload() {
+  expect("OL", "OL", ScpiDecoder::kOverloadValue, Unit::None, true);
+  expect("-OL", "-OL", -ScpiDecoder::kOverloadValue, Unit::None, true);
+  expect("OL with unit", "OL\xa6\xb8", ScpiDecoder::kOverloadValue,
+         Unit::Ohm, true);
+  expect("OL with CRLF", "OL\r\n", ScpiDecoder::kOverloadValue, Unit::None,
+         true);
+  expect("1E+9", "1E+9", 1e9, Unit::None, true);
+  expect("-1E+9", "-1E+9", -1e9, Unit::None, true);
+  expect("1.0E+09", "1.0E+09", 1e9, Unit::None, true);
+  expect("just below", "9.99999E+08", 9.99999e8, Unit::None, false);
+}
+
+static void testExponents() {
+  expect("negative exponent", "1.2345E-03", 1.2345e-3, Unit::None);
+  expect("positive exponent", "1.2345E+03", 1234.5, Unit::None);
+  expect("unsigned exponent", "1.2345E3", 1234.5, Unit::None);
+  expect("lower case e", "-4.2e-1", -0.42, Unit::None);
+  expect("signed mantissa", "+5.000E+00", 5.0, Unit::None);
+  expect("negative both", "-2.5E-06", -2.5e-6, Unit::None);
+  expect("zero", "0.0000E+00", 0.0, Unit::None);
+}
+
+static void testWithoutTerminator() {
+  // Only the first size bytes belong to the line; what follows must not be
+  // read, so there is deliberately no NUL and a digit right after it
+  const char buffer[] = {'1', '.', '5', 'm', 'V', '7', '7'};
+  const auto result = ScpiDecoder::decode(buffer, 5);
+  if (!result.ok || !near(result.value, 1.5e-3) ||
+      result.unit != Unit::Volt) {
+    std::fprintf(stderr, "FAIL unterminated: got ok=%d value=%.12g\n",
+                 result.ok, result.value);
+    ++failures;
+  }
+
+  char gbk[8];
+  std::memcpy(gbk, "2.2k\xa6\xb8", 6);
+  gbk[6] = 'X';
+  gbk[7] = 'X';
+  const auto ohms = ScpiDecoder::decode(gbk, 6);
+  if (!ohms.ok || !near(ohms.value, 2200.0) || ohms.unit != Unit::Ohm) {
+    std::fprintf(stderr, "FAIL unterminated GBK: got ok=%d value=%.12g\n",
+                 ohms.ok, ohms.value);
+    ++failures;
+  }
+
+  // A GBK pair cut off by the end of the line is not a unit
+  reject("truncated GBK pair", std::string("1.2k\xa6", 5));
+
+  expect("trailing CRLF", "1.2345E-03\r\n", 1.2345e-3, Unit::None);
+  expect("leading space", "  3.0V", 3.0, Unit::Volt);
+}
+
+static void testRejected() {
+  reject("empty", "");
+  reject("blank", "   ");
+  reject("no digits", "V");
+  reject("sign only", "-");
+  reject("trailing letters", "1.23Vxyz");
+  reject("two units", "1.23VA");
+  reject("two prefixes", "1.23kmV");
+  reject("unknown unit", "1.23Q");
+  reject("second number", "1.23 4.56");
+  reject("unknown GBK pair", "1.0\xa6\xa6");
+  reject("garbage after exponent", "1.0E+03#");
+}
+
+int main() {
+  testGbk();
+  testUtf8();
+  testPrefixes();
+  testUnits();
+  testOverload();
+  testExponents();
+  testWithoutTerminator();
+  testRejected();
+  if (failures > 0) {
+    std::fprintf(stderr, "%d check(s) failed\n", failures);
+    return 1;
+  }
+  std::printf("all decoder checks passed\n");
+  return 0;
+}